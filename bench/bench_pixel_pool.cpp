@@ -0,0 +1,105 @@
+//
+// Created by dev on 18/10/2026.
+//
+// Memória por abertura de imagem: vector + QImage alocados a cada vez
+// (caminho antigo) contra buffers reciclados do PixelBufferPool.
+//   bench_pixel_pool [arquivo.dcm] [iterações] [vector|pool]
+// Sem o modo, roda cada um num processo filho (fork) para que o pico de RSS
+// de um não contamine o outro. O arquivo é lido uma vez; cada iteração refaz
+// GetBuffer + conversão para 8 bits, mantendo a imagem anterior viva (como o
+// viewer faz ao trocar de imagem).
+#include <QImage>
+
+#include <gdcmImageReader.h>
+#include <dicom/dicom_lib.h>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static int RunMode(const char* path, int iterations, const std::string& mode)
+{
+    gdcm::ImageReader ir;
+    ir.SetFileName(path);
+    if (!ir.Read()) {
+        std::fprintf(stderr, "Falha ao ler %s\n", path);
+        return 1;
+    }
+
+    RawImage probe;
+    if (!DicomReadRawImage(ir, probe)) {
+        std::fprintf(stderr, "Formato de pixel não suportado em %s\n", path);
+        return 2;
+    }
+    WindowLut lut;
+    probe.buildLut(lut, probe.defaultWindow());
+    probe = RawImage();
+    PixelBufferPool::Default().trim();
+
+    rusage r0{}, r1{};
+    getrusage(RUSAGE_SELF, &r0);
+    const auto t0 = std::chrono::steady_clock::now();
+
+    QImage prev;
+    for (int i = 0; i < iterations; ++i) {
+        QImage out;
+        if (mode == "vector") {
+            const gdcm::Image& img = ir.GetImage();
+            std::vector<char> buffer(img.GetBufferLength());
+            img.GetBuffer(buffer.data());
+            const int w = static_cast<int>(img.GetDimensions()[0]);
+            const int h = static_cast<int>(img.GetDimensions()[1]);
+            out = QImage(w, h, QImage::Format_Grayscale8);
+            WindowToGray8(buffer.data(), w, h, lut.bitsAllocated(), lut,
+                          out.bits(), static_cast<size_t>(out.bytesPerLine()));
+        } else {
+            RawImage raw;
+            DicomReadRawImage(ir, raw, -1);   // sem histograma: mesma decodificação do "vector"
+            out = RawToQImage_Grayscale8(raw, lut);
+        }
+        prev = out;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    getrusage(RUSAGE_SELF, &r1);
+
+    const auto st = PixelBufferPool::Default().stats();
+    std::printf("%-6s %8.2f ms/abertura  pico RSS %7.1f MB  page faults: %ld menores, %ld maiores",
+                mode.c_str(), ms / iterations, r1.ru_maxrss / 1024.0,
+                r1.ru_minflt - r0.ru_minflt, r1.ru_majflt - r0.ru_majflt);
+    if (mode == "pool")
+        std::printf("  (pool: %zu reusos, %zu alocações)", st.hits, st.misses);
+    std::printf("\n");
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char* path = argc > 1 ? argv[1] : "anonymized_mamo.dcm";
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    if (argc > 3) return RunMode(path, iterations, argv[3]);
+
+    std::printf("%s, %d aberturas\n", path, iterations);
+    std::fflush(stdout);
+    int rc = 0;
+    for (const char* mode : { "vector", "pool" }) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            const int code = RunMode(path, iterations, mode);
+            std::fflush(stdout);   // _Exit não esvazia o stdio (saída redirecionada se perderia)
+            std::_Exit(code);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,175 @@
+//
+// Created by dev on 18/10/2026.
+//
+// Benchmark antes/depois da conversão para 8 bits:
+//   bench_window_lut [arquivo.dcm] [iterações]
+// "antes" é a conversão original (double + lround por pixel), mantida aqui
+// apenas como referência; "depois" é DicomToQImage_Grayscale8 (LUT).
+// Sem tags de janela a versão atual usa percentis (0,5–99,5%) no lugar do
+// min/max, então a saída só é idêntica em arquivos com (0028,1050)/(0028,1051).
+#include <QImage>
+
+#include <gdcmImageReader.h>
+#include <dicom/dicom_lib.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <array>
+#include <chrono>
+
+// -------------------- conversão original (referência) --------------------
+static QImage DicomToQImage_Grayscale8_Reference(gdcm::ImageReader& ir)
+{
+    const gdcm::Image& img = ir.GetImage();
+    const gdcm::DataSet& ds = ir.GetFile().GetDataSet();
+
+    const int w = static_cast<int>(img.GetDimensions()[0]);
+    const int h = static_cast<int>(img.GetDimensions()[1]);
+
+    std::vector<char> buffer(img.GetBufferLength());
+    if (!img.GetBuffer(buffer.data())) return QImage();
+
+    const auto pf = img.GetPixelFormat();
+    const int bitsAllocated = pf.GetBitsAllocated();
+    const bool isSigned = pf.GetPixelRepresentation() == gdcm::PixelFormat::INT64;
+    if (pf.GetSamplesPerPixel() != 1) return QImage();
+    if (!(bitsAllocated == 8 || bitsAllocated == 16)) return QImage();
+
+    double wc = 0.0, ww = 0.0;
+    bool hasWL = false;
+    {
+        std::string sWC, sWW;
+        if (TryGetDSString(ds, 0x0028, 0x1050, sWC) && TryGetDSString(ds, 0x0028, 0x1051, sWW)) {
+            auto first = [](std::string x){
+                auto p = x.find('\\');
+                if (p != std::string::npos) x = x.substr(0, p);
+                return x;
+            };
+            double tWC=0, tWW=0;
+            if (ParseDouble(first(sWC), tWC) && ParseDouble(first(sWW), tWW) && tWW > 1e-9) {
+                wc = tWC; ww = tWW;
+                hasWL = true;
+            }
+        }
+    }
+
+    QImage out(w, h, QImage::Format_Grayscale8);
+    if (out.isNull()) return QImage();
+
+    auto clamp255 = [](int x){ return static_cast<uchar>(std::max(0, std::min(255, x))); };
+    auto mapWL = [&](double p)->uchar {
+        const double low  = wc - ww / 2.0;
+        const double high = wc + ww / 2.0;
+        if (p <= low) return 0;
+        if (p >= high) return 255;
+        const double t = (p - low) / (high - low);
+        return clamp255(static_cast<int>(std::lround(t * 255.0)));
+    };
+
+    double minV = 0.0, maxV = 0.0;
+    if (!hasWL) {
+        minV =  1e300; maxV = -1e300;
+        auto upd = [&](double v){ minV = std::min(minV, v); maxV = std::max(maxV, v); };
+        if (bitsAllocated == 8) {
+            const uint8_t* px = reinterpret_cast<const uint8_t*>(buffer.data());
+            for (int i=0;i<w*h;++i) upd(px[i]);
+        } else if (isSigned) {
+            const int16_t* px = reinterpret_cast<const int16_t*>(buffer.data());
+            for (int i=0;i<w*h;++i) upd(px[i]);
+        } else {
+            const uint16_t* px = reinterpret_cast<const uint16_t*>(buffer.data());
+            for (int i=0;i<w*h;++i) upd(px[i]);
+        }
+        if (!(maxV > minV)) maxV = minV + 1.0;
+    }
+    auto mapMinMax = [&](double p)->uchar {
+        const double t = (p - minV) / (maxV - minV);
+        return clamp255(static_cast<int>(std::lround(t * 255.0)));
+    };
+
+    for (int y=0;y<h;++y) {
+        uchar* row = out.scanLine(y);
+        for (int x=0;x<w;++x) {
+            const int idx = y*w + x;
+            double p = 0.0;
+            if (bitsAllocated == 8) {
+                p = reinterpret_cast<const uint8_t*>(buffer.data())[idx];
+            } else if (isSigned) {
+                p = reinterpret_cast<const int16_t*>(buffer.data())[idx];
+            } else {
+                p = reinterpret_cast<const uint16_t*>(buffer.data())[idx];
+            }
+            row[x] = hasWL ? mapWL(p) : mapMinMax(p);
+        }
+    }
+    return out;
+}
+
+// -------------------- medição --------------------
+template<typename F>
+static std::vector<double> TimeRuns(int iterations, F&& f)
+{
+    std::vector<double> ms;
+    ms.reserve(static_cast<size_t>(iterations));
+    for (int i = 0; i < iterations; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        f();
+        const auto t1 = std::chrono::steady_clock::now();
+        ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    return ms;
+}
+
+static bool SameImage(const QImage& a, const QImage& b)
+{
+    if (a.size() != b.size()) return false;
+    for (int y = 0; y < a.height(); ++y)
+        if (std::memcmp(a.constScanLine(y), b.constScanLine(y), static_cast<size_t>(a.width())) != 0)
+            return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char* path = argc > 1 ? argv[1] : "anonymized_mamo.dcm";
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    gdcm::ImageReader ir;
+    ir.SetFileName(path);
+    if (!ir.Read()) {
+        std::fprintf(stderr, "Falha ao ler %s\n", path);
+        return 1;
+    }
+
+    const QImage ref = DicomToQImage_Grayscale8_Reference(ir);
+    const QImage lut = DicomToQImage_Grayscale8(ir);
+    if (ref.isNull() || lut.isNull()) {
+        std::fprintf(stderr, "Formato de pixel não suportado em %s\n", path);
+        return 2;
+    }
+    const bool same = SameImage(ref, lut);
+
+    const auto before = TimeRuns(iterations, [&]{ DicomToQImage_Grayscale8_Reference(ir); });
+    const auto after  = TimeRuns(iterations, [&]{ DicomToQImage_Grayscale8(ir); });
+
+    const double mp = static_cast<double>(ref.width()) * ref.height() / 1e6;
+    auto report = [&](const char* name, const std::vector<double>& ms) {
+        const double median = ms[ms.size() / 2];
+        std::printf("%-8s min %8.2f ms  mediana %8.2f ms  %8.1f Mpx/s\n",
+                    name, ms.front(), median, mp / (median / 1000.0));
+    };
+
+    std::printf("%s: %d x %d, %d iterações\n", path, ref.width(), ref.height(), iterations);
+    report("antes", before);
+    report("depois", after);
+    std::printf("speedup (mediana): %.2fx  saída idêntica: %s\n",
+                before[before.size() / 2] / after[after.size() / 2], same ? "sim" : "NÃO");
+    return same ? 0 : 3;
+}
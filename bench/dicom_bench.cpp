@@ -0,0 +1,501 @@
+//
+// Created by dev on 18/10/2026.
+//
+// Benchmark reprodutível do caminho de uma imagem, sem Qt e sem arquivos de
+// teste: gera DICOMs sintéticos em memória (conteúdo determinístico) e mede
+// cada etapa separadamente:
+//   tags       cabeçalho até Pixel Data + TagSchema do overlay e texto (como o viewer)
+//   tags_scan  cabeçalho até Pixel Data + tags como std::string (como o dicom_scan)
+//   decode     ir.Read() + GetBuffer + normalização (sem histograma)
+//   stats      histograma + janela padrão (tags ou percentis)
+//   convert    LUT + remap da imagem inteira para exibição (mesmo código do viewer)
+//   render     pirâmide + remap do nível que cabe numa janela de 1024x1024
+//
+// Configurações: tamanhos x formatos (u8, u12 em 16 bits, s16, rgb8) x com/sem
+// tags de janela x codec (raw = Explicit VR Little Endian, rle, jpegls).
+// Combinações que o GDCM não consegue codificar são puladas (aviso em stderr).
+//
+// Saída: uma linha JSON por configuração/etapa (stdout ou -o), com latência
+// (média, min, p50, p90, p99, max em ms) e vazão na mediana: mpix_s sobre os
+// pixels da imagem inteira e mb_s sobre os bytes que a etapa lê (arquivo
+// codificado em tags/tags_scan/decode, pixels decodificados nas demais).
+//
+//   dicom_bench [opções]
+//     -n <iterações>   repetições medidas por etapa (padrão: 10; +1 de aquecimento)
+//     -o <arquivo>     grava o JSON em arquivo (padrão: stdout)
+//     --quick          só 512x512 e 3 iterações (para CI)
+//     --only <texto>   só configurações cujo nome contém o texto
+//     --keep <pasta>   grava também os .dcm gerados
+#include <gdcmImage.h>
+#include <gdcmImageWriter.h>
+#include <gdcmImageReader.h>
+#include <gdcmImageChangeTransferSyntax.h>
+#include <gdcmTransferSyntax.h>
+#include <gdcmReader.h>
+
+#include <dicom/dicom_raw.h>
+#include <dicom/dicom_lut.h>
+#include <dicom/dicom_stats.h>
+#include <dicom/dicom_pyramid.h>
+#include <dicom/dicom_scan.h>
+#include <dicom/overlay_tags.h>
+#include <dicom/memory_stream.h>
+#include <dicom/png_writer.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+// -------------------- configurações --------------------
+struct BenchFormat
+{
+    const char* name;
+    int  bitsAllocated;
+    int  bitsStored;
+    bool isSigned;
+    int  samplesPerPixel;
+    double slope, intercept;    // Rescale Slope/Intercept gravados no arquivo
+};
+
+static const BenchFormat kFormats[] = {
+    { "u8",   8,  8, false, 1, 1.0,     0.0 },
+    { "u12", 16, 12, false, 1, 1.0,     0.0 },   // mamografia/RX
+    { "s16", 16, 16, true,  1, 1.0, -1024.0 },   // TC
+    { "rgb8", 8,  8, false, 3, 1.0,     0.0 },
+};
+
+struct BenchSize { int width, height; };
+
+static const BenchSize kSizes[] = {
+    {  512,  512 },
+    { 2048, 2048 },
+    { 3328, 4096 },   // mamografia
+};
+
+struct BenchCodec
+{
+    const char* name;
+    gdcm::TransferSyntax::TSType ts;
+};
+
+static const BenchCodec kCodecs[] = {
+    { "raw",    gdcm::TransferSyntax::ExplicitVRLittleEndian },
+    { "rle",    gdcm::TransferSyntax::RLELossless },
+    { "jpegls", gdcm::TransferSyntax::JPEGLSLossless },
+};
+
+struct BenchConfig
+{
+    std::string       name;
+    BenchSize         size;
+    const BenchFormat* format;
+    bool              windowTags;
+    const BenchCodec* codec;
+};
+
+// -------------------- gerador de pixels --------------------
+// Gradiente + anéis suaves + ruído (semente fixa por tamanho/formato), com um
+// marcador saturado num canto e uma faixa de fundo em zero: o histograma tem
+// as caudas que a janela por percentis deve ignorar. O conteúdo também dá aos
+// codecs sem perdas uma taxa de compressão parecida com a de exames reais.
+static uint32_t Fnv1a(const std::string& s)
+{
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s) { h ^= c; h *= 16777619u; }
+    return h;
+}
+
+// Faixa de valores armazenados usada pelo gerador. s16: só a parte útil
+// (como HU em TC), o resto da faixa do tipo fica vazio.
+static void GeneratorRange(const BenchFormat& f, double& lo, double& hi)
+{
+    if (f.isSigned) {
+        lo = -2048.0;
+        hi =  2047.0;
+    } else {
+        lo = 0.0;
+        hi = static_cast<double>((uint64_t(1) << f.bitsStored) - 1);
+    }
+}
+
+static std::vector<char> GeneratePixels(const BenchSize& sz, const BenchFormat& f)
+{
+    const size_t spp = static_cast<size_t>(f.samplesPerPixel);
+    const size_t bps = static_cast<size_t>(f.bitsAllocated / 8);
+    std::vector<char> out(static_cast<size_t>(sz.width) * static_cast<size_t>(sz.height) * spp * bps);
+
+    double lo, hi;
+    GeneratorRange(f, lo, hi);
+
+    std::mt19937 rng(Fnv1a(std::to_string(sz.width) + "x" + std::to_string(sz.height) + f.name));
+    std::normal_distribution<double> noise(0.0, 0.01);
+
+    const double cx = 0.5 * sz.width, cy = 0.5 * sz.height;
+    const double rmax = std::sqrt(cx * cx + cy * cy);
+    const int marker = std::max(8, sz.width / 32);
+    const int band = std::max(1, sz.height / 256);   // < 0,5% das linhas
+
+    DispatchSample(f.bitsAllocated, f.isSigned, [&](auto tag) {
+        typedef decltype(tag) T;
+        T* px = reinterpret_cast<T*>(out.data());
+        for (int y = 0; y < sz.height; ++y) {
+            for (int x = 0; x < sz.width; ++x) {
+                const double r = std::hypot(x - cx, y - cy) / rmax;
+                for (size_t c = 0; c < spp; ++c) {
+                    double t;
+                    if (x < marker && y < marker)       t = 1.0;   // marcador
+                    else if (y >= sz.height - band)     t = 0.0;   // fundo
+                    else {
+                        t = 0.15 + 0.45 * (1.0 - r) + 0.15 * static_cast<double>(x) / sz.width
+                          + 0.1 * std::sin(24.0 * r + 0.7 * static_cast<double>(c)) + noise(rng);
+                        t = std::max(0.02, std::min(0.95, t));
+                    }
+                    px[(static_cast<size_t>(y) * sz.width + x) * spp + c] =
+                        static_cast<T>(std::lround(lo + t * (hi - lo)));
+                }
+            }
+        }
+    });
+    return out;
+}
+
+// -------------------- gerador de arquivos --------------------
+// Texto com padding par (espaço; UI usa '\0').
+static void PutString(gdcm::DataSet& ds, uint16_t g, uint16_t e, gdcm::VR::VRType vr, std::string v)
+{
+    if (v.size() % 2) v.push_back(vr == gdcm::VR::UI ? '\0' : ' ');
+    gdcm::DataElement de(gdcm::Tag(g, e));
+    de.SetVR(vr);
+    de.SetByteValue(v.data(), static_cast<uint32_t>(v.size()));
+    ds.Replace(de);
+}
+
+// UIDs fixos por configuração (2.25.<número>): o arquivo gerado é sempre o mesmo.
+static std::string BenchUid(const std::string& name, int k)
+{
+    return "2.25." + std::to_string(Fnv1a(name)) + std::to_string(100 + k);
+}
+
+static std::string FormatNumber(double v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", v);
+    return buf;
+}
+
+static bool GenerateDicom(const BenchConfig& cfg, const std::vector<char>& pixels, std::string& out)
+{
+    const BenchFormat& f = *cfg.format;
+    const bool rgb = f.samplesPerPixel == 3;
+
+    gdcm::Image im;
+    im.SetNumberOfDimensions(2);
+    im.SetDimension(0, static_cast<unsigned int>(cfg.size.width));
+    im.SetDimension(1, static_cast<unsigned int>(cfg.size.height));
+    gdcm::PixelFormat pf;
+    pf.SetSamplesPerPixel(static_cast<unsigned short>(f.samplesPerPixel));
+    pf.SetBitsAllocated(static_cast<unsigned short>(f.bitsAllocated));
+    pf.SetBitsStored(static_cast<unsigned short>(f.bitsStored));
+    pf.SetHighBit(static_cast<unsigned short>(f.bitsStored - 1));
+    pf.SetPixelRepresentation(f.isSigned ? 1 : 0);
+    im.SetPixelFormat(pf);
+    im.SetPhotometricInterpretation(rgb ? gdcm::PhotometricInterpretation::RGB
+                                        : gdcm::PhotometricInterpretation::MONOCHROME2);
+    im.SetTransferSyntax(gdcm::TransferSyntax::ExplicitVRLittleEndian);
+    if (!rgb) {
+        im.SetSlope(f.slope);
+        im.SetIntercept(f.intercept);
+    }
+
+    gdcm::DataElement pixelData(gdcm::Tag(0x7FE0, 0x0010));
+    pixelData.SetByteValue(pixels.data(), static_cast<uint32_t>(pixels.size()));
+    im.SetDataElement(pixelData);
+
+    gdcm::ImageWriter w;
+    if (cfg.codec->ts == gdcm::TransferSyntax::ExplicitVRLittleEndian) {
+        w.SetImage(im);
+    } else {
+        gdcm::ImageChangeTransferSyntax change;
+        change.SetTransferSyntax(cfg.codec->ts);
+        change.SetInput(im);
+        if (!change.Change()) return false;
+        w.SetImage(change.GetOutput());
+    }
+
+    // TC para o formato com slope/intercept (o GDCM só grava rescale em
+    // classes que o aceitam); captura secundária nos demais
+    gdcm::DataSet& ds = w.GetFile().GetDataSet();
+    const bool ct = f.intercept != 0.0 || f.slope != 1.0;
+    PutString(ds, 0x0008, 0x0016, gdcm::VR::UI, ct ? "1.2.840.10008.5.1.4.1.1.2" : "1.2.840.10008.5.1.4.1.1.7");
+    PutString(ds, 0x0008, 0x0018, gdcm::VR::UI, BenchUid(cfg.name, 0));
+    PutString(ds, 0x0008, 0x0060, gdcm::VR::CS, ct ? "CT" : "OT");
+    PutString(ds, 0x0008, 0x0020, gdcm::VR::DA, "20261018");
+    PutString(ds, 0x0008, 0x103E, gdcm::VR::LO, "dicom_bench " + cfg.name);
+    PutString(ds, 0x0010, 0x0010, gdcm::VR::PN, "BENCH^SINTETICO");
+    PutString(ds, 0x0010, 0x0020, gdcm::VR::LO, "BENCH0001");
+    PutString(ds, 0x0020, 0x000D, gdcm::VR::UI, BenchUid(cfg.name, 1));
+    PutString(ds, 0x0020, 0x000E, gdcm::VR::UI, BenchUid(cfg.name, 2));
+    PutString(ds, 0x0020, 0x0013, gdcm::VR::IS, "1");
+    if (cfg.windowTags && !rgb) {
+        // metade central da faixa usada pelo gerador, em valores de modalidade
+        double lo, hi;
+        GeneratorRange(f, lo, hi);
+        const double c = f.slope * 0.5 * (lo + hi) + f.intercept;
+        const double wdt = f.slope * 0.5 * (hi - lo);
+        PutString(ds, 0x0028, 0x1050, gdcm::VR::DS, FormatNumber(c));
+        PutString(ds, 0x0028, 0x1051, gdcm::VR::DS, FormatNumber(wdt));
+    }
+
+    std::ostringstream os;
+    w.SetStream(os);
+    if (!w.Write()) return false;
+    out = os.str();
+    return true;
+}
+
+// -------------------- medição --------------------
+struct StageTimes
+{
+    const char* stage;
+    double pixelBytes;          // bytes lidos pela etapa (para mb_s)
+    std::vector<double> ms;
+};
+
+static double Percentile(std::vector<double> v, double p)
+{
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    const size_t k = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(v.size())));
+    return v[std::min(v.size() - 1, k ? k - 1 : 0)];
+}
+
+template<typename F>
+static double TimeMs(F&& f)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Remap da imagem inteira pelo mesmo núcleo de RawToDisplayRegion
+// (dicom_lib.h): cinza em 8 bits, RGB em RGB888, linhas contíguas.
+static void RemapForDisplay(const RawImage& raw, const WindowLut& lut, PixelBuffer& dst)
+{
+    const size_t stride = static_cast<size_t>(raw.width) * static_cast<size_t>(raw.samplesPerPixel);
+    dst = PixelBuffer::Allocate(stride * static_cast<size_t>(raw.height));
+    if (dst.empty()) return;
+    RawToDisplayRows(raw, lut, 0, 0, raw.width, raw.height, reinterpret_cast<uint8_t*>(dst.data()), stride);
+}
+
+// Mesmo critério de DicomViewWidget::pickLevel para a imagem inteira numa
+// janela viewport x viewport.
+static size_t PickLevel(const RawPyramid& levels, int viewport)
+{
+    const double s = std::min(static_cast<double>(viewport) / levels[0]->width,
+                              static_cast<double>(viewport) / levels[0]->height);
+    if (s >= 1.0 || levels.size() < 2) return 0;
+    const int k = static_cast<int>(std::floor(std::log2(1.0 / s)));
+    return static_cast<size_t>(std::max(0, std::min(static_cast<int>(levels.size()) - 1, k)));
+}
+
+static bool RunConfig(const std::string& file, int iterations, std::vector<StageTimes>& stages)
+{
+    const std::vector<gdcm::Tag> tags = {
+        gdcm::Tag(0x0010, 0x0010), gdcm::Tag(0x0010, 0x0020), gdcm::Tag(0x0008, 0x0020),
+        gdcm::Tag(0x0008, 0x0060), gdcm::Tag(0x0008, 0x103E), gdcm::Tag(0x0020, 0x000E),
+        gdcm::Tag(0x0028, 0x1050), gdcm::Tag(0x0028, 0x1051),
+    };
+    stages = { { "tags", 0.0, {} }, { "tags_scan", 0.0, {} }, { "decode", 0.0, {} },
+               { "stats", 0.0, {} }, { "convert", 0.0, {} }, { "render", 0.0, {} } };
+
+    for (int it = -1; it < iterations; ++it) {   // it = -1: aquecimento (pool, caches)
+        double t[6];
+        bool ok = true;
+
+        t[0] = TimeMs([&]{
+            MemoryIStream is(file.data(), file.size());
+            gdcm::Reader r;
+            r.SetStream(is);
+            ok = r.ReadUpToTag(gdcm::Tag(0x7FE0, 0x0010), std::set<gdcm::Tag>());
+            if (ok) ok = !BuildMetadataText(r.GetFile().GetDataSet()).empty();
+        });
+        if (!ok) return false;
+
+        t[1] = TimeMs([&]{
+            MemoryIStream is(file.data(), file.size());
+            gdcm::Reader r;
+            r.SetStream(is);
+            ok = r.ReadUpToTag(gdcm::Tag(0x7FE0, 0x0010), std::set<gdcm::Tag>());
+            if (ok) ok = ExtractStringTags(r.GetFile().GetDataSet(), tags).size() == tags.size();
+        });
+        if (!ok) return false;
+
+        auto raw = std::make_shared<RawImage>();
+        t[2] = TimeMs([&]{
+            MemoryIStream is(file.data(), file.size());
+            gdcm::ImageReader ir;
+            ir.SetStream(is);
+            ok = ReadDicomImage(ir) && DicomReadRawImage(ir, *raw, -1);
+        });
+        if (!ok) return false;
+
+        WindowRange win;
+        t[3] = TimeMs([&]{
+            raw->histogram->get();   // o que a tecla "A" paga na primeira vez
+            win = raw->defaultWindow();
+        });
+
+        PixelBuffer display;
+        t[4] = TimeMs([&]{
+            WindowLut lut;
+            raw->buildLut(lut, win);
+            RemapForDisplay(*raw, lut, display);
+        });
+        display.reset();
+
+        t[5] = TimeMs([&]{
+            const RawPyramid levels = BuildRawPyramid(raw);
+            const RawImage& lvl = *levels[PickLevel(levels, 1024)];
+            WindowLut lut;
+            lvl.buildLut(lut, win);
+            RemapForDisplay(lvl, lut, display);
+        });
+
+        if (it < 0) {
+            stages[0].pixelBytes = stages[1].pixelBytes = stages[2].pixelBytes =
+                static_cast<double>(file.size());
+            stages[3].pixelBytes = stages[4].pixelBytes = stages[5].pixelBytes =
+                static_cast<double>(raw->pixels.size());
+            continue;
+        }
+        for (size_t s = 0; s < stages.size(); ++s) stages[s].ms.push_back(t[s]);
+    }
+    return true;
+}
+
+// -------------------- saída --------------------
+static void WriteResults(std::FILE* out, const BenchConfig& cfg, size_t fileBytes,
+                         const std::vector<StageTimes>& stages)
+{
+    const double mpix = static_cast<double>(cfg.size.width) * cfg.size.height / 1e6;
+    for (const StageTimes& st : stages) {
+        double sum = 0.0;
+        for (double v : st.ms) sum += v;
+        const double mean = st.ms.empty() ? 0.0 : sum / static_cast<double>(st.ms.size());
+        const double p50 = Percentile(st.ms, 50.0);
+        const double secs = std::max(1e-9, p50 / 1000.0);
+        std::fprintf(out,
+            "{\"config\":\"%s\",\"width\":%d,\"height\":%d,\"format\":\"%s\",\"bits_allocated\":%d,"
+            "\"bits_stored\":%d,\"signed\":%s,\"samples_per_pixel\":%d,\"window_tags\":%s,"
+            "\"codec\":\"%s\",\"file_bytes\":%zu,\"stage\":\"%s\",\"n\":%zu,"
+            "\"mean_ms\":%.4f,\"min_ms\":%.4f,\"p50_ms\":%.4f,\"p90_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f,"
+            "\"mpix_s\":%.2f,\"mb_s\":%.2f}\n",
+            cfg.name.c_str(), cfg.size.width, cfg.size.height, cfg.format->name,
+            cfg.format->bitsAllocated, cfg.format->bitsStored, cfg.format->isSigned ? "true" : "false",
+            cfg.format->samplesPerPixel, cfg.windowTags ? "true" : "false", cfg.codec->name,
+            fileBytes, st.stage, st.ms.size(),
+            mean, Percentile(st.ms, 0.0), p50, Percentile(st.ms, 90.0), Percentile(st.ms, 99.0),
+            Percentile(st.ms, 100.0),
+            mpix / secs, st.pixelBytes / (1024.0 * 1024.0) / secs);
+    }
+    std::fflush(out);
+}
+
+// -------------------- main --------------------
+static void PrintUsage(const char* argv0)
+{
+    std::fprintf(stderr,
+        "uso: %s [opções]\n"
+        "  -n <iterações>   repetições medidas por etapa (padrão: 10)\n"
+        "  -o <arquivo>     grava o JSON em arquivo (padrão: stdout)\n"
+        "  --quick          só 512x512 e 3 iterações\n"
+        "  --only <texto>   só configurações cujo nome contém o texto\n"
+        "  --keep <pasta>   grava também os .dcm gerados\n",
+        argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 10;
+    bool quick = false;
+    std::string outPath, only, keepDir;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto need = [&](int n) {
+            if (i + n >= argc) { PrintUsage(argv[0]); std::exit(1); }
+        };
+        if (a == "-n")            { need(1); iterations = std::max(1, std::atoi(argv[++i])); }
+        else if (a == "-o")       { need(1); outPath = argv[++i]; }
+        else if (a == "--quick")  { quick = true; iterations = 3; }
+        else if (a == "--only")   { need(1); only = argv[++i]; }
+        else if (a == "--keep")   { need(1); keepDir = argv[++i]; }
+        else if (a == "-h" || a == "--help") { PrintUsage(argv[0]); return 0; }
+        else { PrintUsage(argv[0]); return 1; }
+    }
+
+    std::FILE* out = stdout;
+    if (!outPath.empty() && !(out = std::fopen(outPath.c_str(), "w"))) {
+        std::fprintf(stderr, "falha ao abrir %s\n", outPath.c_str());
+        return 1;
+    }
+    if (!keepDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(keepDir, ec);
+    }
+
+    int failed = 0;
+    for (const BenchSize& sz : kSizes) {
+        if (quick && sz.width > 512) continue;
+        for (const BenchFormat& f : kFormats) {
+            std::vector<char> pixels;   // gerado uma vez por tamanho/formato
+            for (int wl = 0; wl < 2; ++wl) {
+                if (wl && f.samplesPerPixel != 1) continue;   // RGB não usa janela
+                for (const BenchCodec& codec : kCodecs) {
+                    BenchConfig cfg;
+                    cfg.size = sz;
+                    cfg.format = &f;
+                    cfg.windowTags = wl != 0;
+                    cfg.codec = &codec;
+                    cfg.name = std::to_string(sz.width) + "x" + std::to_string(sz.height) + "_" + f.name
+                             + (cfg.windowTags ? "_wl_" : "_") + codec.name;
+                    if (!only.empty() && cfg.name.find(only) == std::string::npos) continue;
+
+                    if (pixels.empty()) pixels = GeneratePixels(sz, f);
+                    std::string file;
+                    if (!GenerateDicom(cfg, pixels, file)) {
+                        std::fprintf(stderr, "pulado (codificação não suportada): %s\n", cfg.name.c_str());
+                        continue;
+                    }
+                    if (!keepDir.empty())
+                        WriteFileBytes((fs::path(keepDir) / (cfg.name + ".dcm")).string(), file.data(), file.size());
+
+                    std::vector<StageTimes> stages;
+                    if (!RunConfig(file, iterations, stages)) {
+                        std::fprintf(stderr, "falha na leitura: %s\n", cfg.name.c_str());
+                        ++failed;
+                        continue;
+                    }
+                    WriteResults(out, cfg, file.size(), stages);
+                    std::fprintf(stderr, "%-28s %8.1f KB  decode p50 %8.2f ms  convert p50 %7.2f ms\n",
+                                 cfg.name.c_str(), static_cast<double>(file.size()) / 1024.0,
+                                 Percentile(stages[1].ms, 50.0), Percentile(stages[3].ms, 50.0));
+                }
+            }
+        }
+    }
+
+    if (out != stdout) std::fclose(out);
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,368 @@
+//
+// Created by dev on 18/10/2026.
+//
+// Conversão em lote, sem Qt: DICOM -> PNG (8 bits, window/level) ou raw.
+// Estágios em pipeline, ligados por filas limitadas:
+//   leitura (disco) -> decodificação (GDCM) -> janela + codificação -> escrita
+//
+//   dicom_batch [opções] <arquivo|pasta|@lista.txt>...
+//     -o <pasta>       pasta de saída (padrão: .)
+//     -f png|raw       formato de saída (padrão: png)
+//     -j <n>           threads de decodificação (padrão: núcleos da máquina)
+//     --max-size <n>   reduz 2x2 até o maior lado ficar <= n (padrão: sem redução)
+//     --wl <c> <w>     janela fixa (padrão: tags do arquivo ou percentis 0,5–99,5%)
+//     --trace <json>   grava o tempo de cada etapa em formato Chrome trace
+#include <gdcmImageReader.h>
+
+#include <dicom/dicom_raw.h>
+#include <dicom/dicom_lut.h>
+#include <dicom/dicom_pyramid.h>
+#include <dicom/bounded_queue.h>
+#include <dicom/memory_stream.h>
+#include <dicom/perf_trace.h>
+#include <dicom/png_writer.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <set>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+// -------------------- opções / entradas --------------------
+struct BatchOptions
+{
+    fs::path    outDir = ".";
+    std::string format = "png";
+    int         decodeThreads = 0;
+    int         maxSize = 0;
+    bool        fixedWindow = false;
+    double      wc = 0.0, ww = 0.0;
+};
+
+struct BatchInput
+{
+    std::string path;
+    fs::path    outRel;         // caminho relativo na saída, sem extensão
+    bool        fromDirectory;  // achado varrendo uma pasta (não pedido pelo nome)
+};
+
+// Pastas: todo arquivo regular entra (nomes por UID, como
+// 1.3.12.2.1107.5.1.4.12345, não têm extensão confiável); o que o GDCM
+// rejeitar sem o preâmbulo "DICM" é contado como não-DICOM, não como falha.
+// Só .dcm/.dicom saem do nome de saída: em nomes por UID o "sufixo" é parte
+// do identificador e irmãos difeririam apenas nele.
+static fs::path OutputStem(fs::path p)
+{
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return std::tolower(c); });
+    if (ext == ".dcm" || ext == ".dicom") p.replace_extension();
+    return p;
+}
+
+static void CollectInputs(const std::string& arg, std::vector<BatchInput>& inputs)
+{
+    std::error_code ec;
+    if (!arg.empty() && arg[0] == '@') {
+        std::ifstream list(arg.substr(1));
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) CollectInputs(line, inputs);
+        }
+    } else if (fs::is_directory(arg, ec)) {
+        const fs::path root(arg);
+        for (const auto& de : fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec)) {
+            if (!de.is_regular_file(ec)) continue;
+            inputs.push_back({ de.path().string(), OutputStem(de.path().lexically_relative(root)), true });
+        }
+    } else {
+        inputs.push_back({ arg, OutputStem(fs::path(arg).filename()), false });
+    }
+}
+
+static bool HasDicomPreamble(const std::vector<char>& bytes)
+{
+    return bytes.size() >= 132 && std::memcmp(bytes.data() + 128, "DICM", 4) == 0;
+}
+
+// Remove entradas repetidas (pastas sobrepostas, o mesmo arquivo na lista e
+// na linha de comando) e resolve nomes de saída iguais (IM0001 em pastas
+// diferentes, a.dcm ao lado de a.dicom) com sufixo _2, _3... A comparação
+// ignora maiúsculas, como em sistemas de arquivos que não as distinguem.
+static size_t ResolveOutputNames(std::vector<BatchInput>& inputs)
+{
+    auto key = [](const fs::path& p) {
+        std::string s = p.generic_string();
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return std::tolower(c); });
+        return s;
+    };
+
+    std::set<std::string> sources;
+    std::set<std::string> names;
+    std::vector<BatchInput> unique;
+    size_t renamed = 0;
+    for (auto& in : inputs) {
+        std::error_code ec;
+        fs::path canon = fs::weakly_canonical(in.path, ec);
+        if (!sources.insert(ec ? in.path : canon.string()).second) continue;
+
+        fs::path rel = in.outRel;
+        for (int n = 2; !names.insert(key(rel)).second; ++n)
+            rel = fs::path(in.outRel.string() + "_" + std::to_string(n));
+        if (rel != in.outRel) {
+            std::fprintf(stderr, "aviso: saída repetida para %s; gravando como %s\n",
+                         in.path.c_str(), rel.string().c_str());
+            ++renamed;
+            in.outRel = rel;
+        }
+        unique.push_back(std::move(in));
+    }
+    inputs.swap(unique);
+    return renamed;
+}
+
+// -------------------- pipeline --------------------
+struct BatchJob
+{
+    const BatchInput*         input = nullptr;
+    std::vector<char>         fileBytes;
+    std::shared_ptr<RawImage> raw;
+    std::vector<uint8_t>      encoded;
+    PixelBuffer               rawOut;     // -f raw: escreve o buffer decodificado sem copiar
+    fs::path                  outPath;
+};
+typedef std::unique_ptr<BatchJob> BatchJobPtr;
+
+struct BatchStats
+{
+    std::atomic<size_t> ok{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> notDicom{0};    // de pastas, sem preâmbulo e rejeitados pelo GDCM
+    std::atomic<size_t> bytesIn{0};
+    std::atomic<size_t> bytesOut{0};
+};
+
+static std::mutex g_logMutex;
+
+static void LogFailure(const std::string& path, const char* what)
+{
+    std::lock_guard<std::mutex> lk(g_logMutex);
+    std::fprintf(stderr, "falha (%s): %s\n", what, path.c_str());
+}
+
+static bool DecodeJob(BatchJob& job)
+{
+    MemoryIStream is(job.fileBytes.data(), job.fileBytes.size());
+    gdcm::ImageReader ir;
+    ir.SetStream(is);
+    if (!ReadDicomImage(ir)) return false;
+
+    job.raw = std::make_shared<RawImage>();
+    const bool ok = DicomReadRawImage(ir, *job.raw, 1);   // o paralelismo já é entre arquivos
+    std::vector<char>().swap(job.fileBytes);
+    return ok;
+}
+
+// false se faltar memória para a redução ou para a imagem de 8 bits
+static bool ConvertJob(BatchJob& job, const BatchOptions& opt)
+{
+    std::shared_ptr<const RawImage> img = job.raw;
+    job.raw.reset();
+    while (opt.maxSize > 0 && std::max(img->width, img->height) > opt.maxSize) {
+        img = DownsampleRaw(*img);
+        if (!img) return false;
+    }
+
+    if (opt.format == "raw") {
+        job.rawOut = img->pixels;
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), "_%dx%d_%d%c%s.raw", img->width, img->height,
+                      img->bitsAllocated, img->isSigned ? 's' : 'u', img->isColor() ? "_rgb" : "");
+        job.outPath = opt.outDir / job.input->outRel;
+        job.outPath += suffix;
+    } else {
+        WindowLut lut;
+        img->buildLut(lut, opt.fixedWindow ? WindowFromCenterWidth(opt.wc, opt.ww) : img->defaultWindow());
+        PixelBuffer gray = PixelBuffer::Allocate(img->pixelCount());
+        if (gray.empty()) return false;
+        uint8_t* g = reinterpret_cast<uint8_t*>(gray.data());
+        WindowToGray8(img->pixels.data(), img->width, img->height, img->bitsAllocated, lut,
+                      g, static_cast<size_t>(img->width), img->samplesPerPixel);
+        PERF_SCOPE("encode_png");
+        job.encoded = EncodePngGray8(g, img->width, img->height, static_cast<size_t>(img->width));
+        job.outPath = opt.outDir / job.input->outRel;
+        job.outPath += ".png";
+    }
+    return true;
+}
+
+static bool WriteJob(const BatchJob& job)
+{
+    PERF_SCOPE("write");
+    std::error_code ec;
+    fs::create_directories(job.outPath.parent_path(), ec);
+    if (!job.rawOut.empty())
+        return WriteFileBytes(job.outPath.string(), job.rawOut.data(), job.rawOut.size());
+    return WriteFileBytes(job.outPath.string(), job.encoded.data(), job.encoded.size());
+}
+
+static void RunBatch(const std::vector<BatchInput>& inputs, const BatchOptions& opt, BatchStats& stats)
+{
+    const int nDecode  = std::max(1, opt.decodeThreads);
+    const int nConvert = std::max(1, nDecode / 2);
+    const int nRead    = 2;
+    const int nWrite   = 2;
+
+    // filas pequenas: limitam quantos arquivos inteiros ficam em memória
+    BoundedQueue<BatchJobPtr> qRead(static_cast<size_t>(2 * nDecode), nRead);
+    BoundedQueue<BatchJobPtr> qDecoded(static_cast<size_t>(2 * nConvert), nDecode);
+    BoundedQueue<BatchJobPtr> qEncoded(static_cast<size_t>(2 * nWrite), nConvert);
+
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < nRead; ++i)
+        threads.emplace_back([&]{
+            for (size_t k; (k = next.fetch_add(1)) < inputs.size(); ) {
+                auto job = std::make_unique<BatchJob>();
+                job->input = &inputs[k];
+                if (!ReadFileToBuffer(job->input->path, job->fileBytes)) {
+                    LogFailure(job->input->path, "leitura");
+                    ++stats.failed;
+                    continue;
+                }
+                stats.bytesIn += job->fileBytes.size();
+                qRead.push(std::move(job));
+            }
+            qRead.close();
+        });
+
+    for (int i = 0; i < nDecode; ++i)
+        threads.emplace_back([&]{
+            BatchJobPtr job;
+            while (qRead.pop(job)) {
+                const bool preamble = HasDicomPreamble(job->fileBytes);
+                if (!DecodeJob(*job)) {
+                    if (job->input->fromDirectory && !preamble) {
+                        ++stats.notDicom;
+                        continue;
+                    }
+                    LogFailure(job->input->path, "decodificação");
+                    ++stats.failed;
+                    continue;
+                }
+                qDecoded.push(std::move(job));
+            }
+            qDecoded.close();
+        });
+
+    for (int i = 0; i < nConvert; ++i)
+        threads.emplace_back([&]{
+            BatchJobPtr job;
+            while (qDecoded.pop(job)) {
+                if (!ConvertJob(*job, opt)) {
+                    LogFailure(job->input->path, "conversão");
+                    ++stats.failed;
+                    continue;
+                }
+                qEncoded.push(std::move(job));
+            }
+            qEncoded.close();
+        });
+
+    for (int i = 0; i < nWrite; ++i)
+        threads.emplace_back([&]{
+            BatchJobPtr job;
+            while (qEncoded.pop(job)) {
+                if (!WriteJob(*job)) {
+                    LogFailure(job->outPath.string(), "escrita");
+                    ++stats.failed;
+                    continue;
+                }
+                stats.bytesOut += job->rawOut.empty() ? job->encoded.size() : job->rawOut.size();
+                ++stats.ok;
+            }
+        });
+
+    for (auto& t : threads) t.join();
+}
+
+// -------------------- main --------------------
+static void PrintUsage(const char* argv0)
+{
+    std::fprintf(stderr,
+        "uso: %s [opções] <arquivo|pasta|@lista.txt>...\n"
+        "  -o <pasta>       pasta de saída (padrão: .)\n"
+        "  -f png|raw       formato de saída (padrão: png)\n"
+        "  -j <n>           threads de decodificação (padrão: núcleos da máquina)\n"
+        "  --max-size <n>   reduz 2x2 até o maior lado ficar <= n\n"
+        "  --wl <c> <w>     janela fixa (padrão: tags do arquivo ou percentis 0,5–99,5%%)\n"
+        "  --trace <json>   grava o tempo de cada etapa em formato Chrome trace\n",
+        argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    BatchOptions opt;
+    opt.decodeThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<std::string> args;
+    std::string tracePath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto need = [&](int n) {
+            if (i + n >= argc) { PrintUsage(argv[0]); std::exit(1); }
+        };
+        if (a == "-o")              { need(1); opt.outDir = argv[++i]; }
+        else if (a == "-f")         { need(1); opt.format = argv[++i]; }
+        else if (a == "-j")         { need(1); opt.decodeThreads = std::atoi(argv[++i]); }
+        else if (a == "--max-size") { need(1); opt.maxSize = std::atoi(argv[++i]); }
+        else if (a == "--wl")       { need(2); opt.wc = std::atof(argv[++i]); opt.ww = std::atof(argv[++i]);
+                                      opt.fixedWindow = opt.ww > 1e-9; }
+        else if (a == "--trace")    { need(1); tracePath = argv[++i]; }
+        else if (a == "-h" || a == "--help") { PrintUsage(argv[0]); return 0; }
+        else args.push_back(a);
+    }
+    if (args.empty() || !(opt.format == "png" || opt.format == "raw")) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<BatchInput> inputs;
+    for (const auto& a : args) CollectInputs(a, inputs);
+    const size_t renamed = ResolveOutputNames(inputs);
+    if (inputs.empty()) {
+        std::fprintf(stderr, "nenhum arquivo de entrada\n");
+        return 1;
+    }
+
+    if (!tracePath.empty()) PerfTrace::Instance().setEnabled(true);
+
+    BatchStats stats;
+    const auto t0 = std::chrono::steady_clock::now();
+    RunBatch(inputs, opt, stats);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    const double mbIn = static_cast<double>(stats.bytesIn) / (1024.0 * 1024.0);
+    std::printf("%zu arquivos convertidos, %zu falhas, %zu ignorados (não DICOM) em %.2f s\n",
+                stats.ok.load(), stats.failed.load(), stats.notDicom.load(), secs);
+    if (renamed)
+        std::printf("%zu saídas renomeadas por conflito de nome\n", renamed);
+    std::printf("%.1f arquivos/s, %.1f MB/s lidos (%.1f MB), %.1f MB escritos\n",
+                stats.ok / secs, mbIn / secs, mbIn, static_cast<double>(stats.bytesOut) / (1024.0 * 1024.0));
+    if (!tracePath.empty() && !PerfTrace::Instance().writeChromeTrace(tracePath))
+        std::fprintf(stderr, "falha ao gravar %s\n", tracePath.c_str());
+    return stats.failed ? 2 : 0;
+}
@@ -5,7 +5,44 @@
 #ifndef READ_DICOM_GDCM_DICOMVIEWWIDGET_H
 #define READ_DICOM_GDCM_DICOMVIEWWIDGET_H
 
+#include <QWidget>
+#include <QPainter>
+#include <QPixmap>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QResizeEvent>
+#include <QKeyEvent>
+#include <QMetaObject>
+
+#include <dicom/dicom_lib.h>
+#include <dicom/dicom_pyramid.h>
+#include <dicom/dicom_series.h>
+#include <dicom/perf_trace.h>
+#include <dicom/background_tasks.h>
+
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
 // -------------------- Viewer widget: desenha imagem + overlay --------------------
+// Com setRawImage() o widget guarda os pixels crus e o arraste com o botão
+// esquerdo ajusta a janela (horizontal: largura, vertical: centro); "A" aplica
+// a janela automática por percentis (histograma calculado no primeiro uso e
+// guardado com a imagem). Roda do mouse faz zoom no cursor, botão
+// direito/meio arrasta (pan), "R" reseta.
+// Com uma série (setSeries), roda/setas trocam de fatia e Ctrl + roda faz zoom;
+// enquanto a fatia decodifica, a miniatura em disco dela (se houver) aparece
+// esticada no lugar da imagem (setPreview).
+//
+// Renderização: pirâmide de níveis 2x2 dos pixels crus, dividida em tiles de
+// 8 bits remapeados sob demanda; a cada mudança de zoom/pan/janela só os tiles
+// visíveis do nível mais próximo da resolução da tela são desenhados, num
+// pixmap do tamanho do widget que é reaproveitado enquanto a vista não muda
+// (ex.: troca do texto do overlay).
+//
+// "P" liga a instrumentação (perf_trace.h) e mostra, no canto superior
+// direito, o tempo de cada etapa e os contadores acumulados.
 class DicomViewWidget : public QWidget
 {
 public:
@@ -13,63 +50,518 @@ public:
     {
         setMinimumSize(800, 600);
         setAutoFillBackground(true);
+        setFocusPolicy(Qt::StrongFocus);
+    }
+
+    ~DicomViewWidget() override
+    {
+        retireSeries();
+        m_retired.waitAll();
+    }
+
+    void setImage(const QImage& img)
+    {
+        m_raw.reset();
+        m_levels.clear();
+        m_img = img;
+        m_previewSize = QSize();
+        resetView();
+    }
+
+    // Pré-visualização em baixa resolução ocupando a geometria da imagem
+    // completa (fullSize). Zoom, pan e janela ficam como estão; os pixels crus
+    // que chegarem depois (setRawPyramid) substituem a pré-visualização.
+    void setPreview(const QImage& preview, const QSize& fullSize)
+    {
+        if (preview.isNull() || fullSize.isEmpty()) return;
+        const bool sameGeometry = imageSize() == fullSize;
+        m_levels.clear();
+        m_img = preview;
+        m_previewSize = fullSize;
+        if (sameGeometry) invalidateView();
+        else resetView();
     }
 
-    void setImage(const QImage& img) { m_img = img; update(); }
     void setOverlayText(const QString& t) { m_overlay = t; update(); }
 
+    // Estado do carregamento (canto superior esquerdo); vazio esconde.
+    void setLoadingText(const QString& t) { m_loading = t; update(); }
+
+    void setRawImage(std::shared_ptr<const RawImage> raw)
+    {
+        setRawPyramid(BuildRawPyramid(std::move(raw)), false);
+    }
+
+    // keepView: mantém janela, zoom e pan (troca de fatia numa série)
+    void setRawPyramid(const RawPyramid& levels, bool keepView)
+    {
+        const bool sameGeometry = !levels.empty()
+            && imageSize() == QSize(levels[0]->width, levels[0]->height);
+        const bool keep = keepView && m_raw && !levels.empty()
+            && levels[0]->bitsAllocated == m_raw->bitsAllocated && levels[0]->isSigned == m_raw->isSigned
+            && levels[0]->samplesPerPixel == m_raw->samplesPerPixel;
+
+        m_raw = levels.empty() ? nullptr : levels[0];
+        m_img = QImage();
+        m_previewSize = QSize();
+        m_levels.clear();
+        if (m_raw && !m_raw->isNull()) {
+            for (auto& lr : levels) {
+                Level lvl;
+                lvl.raw = lr;
+                lvl.cols = (lr->width  + kTileSize - 1) / kTileSize;
+                lvl.rows = (lr->height + kTileSize - 1) / kTileSize;
+                lvl.tiles.resize(static_cast<size_t>(lvl.cols) * static_cast<size_t>(lvl.rows));
+                m_levels.push_back(std::move(lvl));
+            }
+            if (!keep) {
+                m_initialWin = m_raw->defaultWindow();
+                m_win = m_initialWin;
+            }
+            // slope/intercept podem mudar de uma fatia para outra
+            m_raw->buildLut(m_lut, m_win);
+            ++m_winGen;
+        }
+        if (keep && sameGeometry) invalidateView();
+        else resetView();
+    }
+
+    // Série: o widget passa a ser dono do loader; a roda do mouse troca de fatia
+    // (Ctrl + roda faz zoom) e fatias ainda não decodificadas não bloqueiam:
+    // a anterior continua na tela até a nova ficar pronta.
+    void setSeries(std::unique_ptr<SeriesLoader> loader)
+    {
+        retireSeries();
+        m_series = std::move(loader);
+        m_slice = 0;
+        m_shownSlice = -1;
+        m_seriesShown = false;
+        m_wheelAccum = 0;
+        if (!m_series || m_series->size() == 0) return;
+
+        m_series->setReadyCallback([this](int index, bool) {
+            // thread do worker -> thread da GUI
+            QMetaObject::invokeMethod(this, [this, index]{ onSliceReady(index); }, Qt::QueuedConnection);
+        });
+        goToSlice(0, 1);
+    }
+
+    int currentSlice() const { return m_slice; }
+
+    void setWindowCenterWidth(double wc, double ww) { setWindow(WindowFromCenterWidth(wc, ww)); }
+
+    double windowCenter() const { return (m_win.low + m_win.high) / 2.0; }
+    double windowWidth() const { return m_win.high - m_win.low; }
+
+    // Liga a instrumentação junto com o overlay e desliga (limpando o que foi
+    // medido) ao esconder, a não ser que já estivesse ligada antes
+    // (READ_DICOM_TRACE grava o trace ao sair).
+    void setPerfOverlayVisible(bool on)
+    {
+        if (on == m_perfOverlay) return;
+        m_perfOverlay = on;
+        PerfTrace& trace = PerfTrace::Instance();
+        if (on && !PerfTrace::Enabled()) {
+            trace.setEnabled(true);
+            m_perfOwned = true;
+        } else if (!on && m_perfOwned) {
+            trace.setEnabled(false);
+            trace.clear();
+            m_perfOwned = false;
+        }
+        update();
+    }
+
+    void resetView()
+    {
+        m_zoom = 1.0;
+        m_pan = QPointF();
+        invalidateView();
+    }
+
 protected:
     void paintEvent(QPaintEvent*) override
     {
+        PERF_SCOPE("paint");
         QPainter p(this);
-        p.fillRect(rect(), Qt::black);
-
-        if (!m_img.isNull()) {
-            // calcula retângulo com aspecto preservado
-            QSize imgSz = m_img.size();
-            QSize wndSz = size();
-            QSize scaled = imgSz.scaled(wndSz, Qt::KeepAspectRatio);
-
-            QRect target((wndSz.width() - scaled.width())/2,
-                         (wndSz.height() - scaled.height())/2,
-                         scaled.width(), scaled.height());
 
-            p.setRenderHint(QPainter::SmoothPixmapTransform, true);
-            p.drawImage(target, m_img);
+        if (!m_img.isNull() || !m_levels.empty()) {
+            ensureViewCache();
+            p.drawPixmap(0, 0, m_viewCache);
 
             // Overlay no canto inferior direito (com sombra)
-            if (!m_overlay.isEmpty()) {
-                const int margin = 12;
-
-                QFont f = p.font();
-                f.setPointSize(14);
-                f.setBold(true);
-                p.setFont(f);
-
-                QRect overlayRect = rect().adjusted(margin, margin, -margin, -margin);
-
-                // sombra
-                p.setPen(QColor(0,0,0,200));
-                p.drawText(overlayRect.adjusted(2,2,2,2),
-                           Qt::AlignRight | Qt::AlignBottom,
-                           m_overlay);
-
-                // texto
-                p.setPen(QColor(255,255,255,230));
-                p.drawText(overlayRect,
-                           Qt::AlignRight | Qt::AlignBottom,
-                           m_overlay);
+            if (!m_overlay.isEmpty())
+                drawShadowText(p, Qt::AlignRight | Qt::AlignBottom, m_overlay);
+
+            if (m_raw) {
+                QString info = QString("WL: %1  WW: %2")
+                                   .arg(windowCenter(), 0, 'f', 0)
+                                   .arg(windowWidth(), 0, 'f', 0);
+                if (m_series) {
+                    info = QString("Fatia: %1/%2%3\n")
+                               .arg(m_slice + 1).arg(m_series->size())
+                               .arg(QString(m_shownSlice != m_slice ? " (carregando)" : "")) + info;
+                }
+                drawShadowText(p, Qt::AlignLeft | Qt::AlignBottom, info);
             }
         } else {
+            p.fillRect(rect(), Qt::black);
+            if (!m_overlay.isEmpty())
+                drawShadowText(p, Qt::AlignRight | Qt::AlignBottom, m_overlay);
             p.setPen(Qt::white);
-            p.drawText(rect(), Qt::AlignCenter, "Nenhuma imagem carregada");
+            if (m_loading.isEmpty())
+                p.drawText(rect(), Qt::AlignCenter, "Nenhuma imagem carregada");
+        }
+
+        if (!m_loading.isEmpty())
+            drawShadowText(p, Qt::AlignLeft | Qt::AlignTop, m_loading);
+        if (m_perfOverlay)
+            drawShadowText(p, Qt::AlignRight | Qt::AlignTop, perfText());
+    }
+
+    void resizeEvent(QResizeEvent*) override { invalidateView(); }
+
+    void mousePressEvent(QMouseEvent* e) override
+    {
+        m_dragStart = e->pos();
+        if (m_raw && e->button() == Qt::LeftButton) {
+            m_drag = DragWindow;
+            m_dragWin = m_win;
+        } else if (e->button() == Qt::RightButton || e->button() == Qt::MiddleButton) {
+            m_drag = DragPan;
+            m_dragPan = m_pan;
+        }
+    }
+
+    void mouseMoveEvent(QMouseEvent* e) override
+    {
+        const QPoint d = e->pos() - m_dragStart;
+
+        if (m_drag == DragWindow) {
+            // largura multiplicativa (mesma sensação em 8 e 16 bits),
+            // centro proporcional à largura atual
+            const double ww0 = m_dragWin.high - m_dragWin.low;
+            const double wc0 = (m_dragWin.low + m_dragWin.high) / 2.0;
+            const double ww = std::max(1.0, ww0 * std::exp(d.x() * 0.005));
+            const double wc = wc0 + d.y() * ww0 * 0.0025;
+            setWindowCenterWidth(wc, ww);
+        } else if (m_drag == DragPan) {
+            m_pan = m_dragPan + QPointF(d.x(), d.y());
+            invalidateView();
+        }
+    }
+
+    void mouseReleaseEvent(QMouseEvent*) override { m_drag = DragNone; }
+
+    void mouseDoubleClickEvent(QMouseEvent* e) override
+    {
+        if (m_raw && e->button() == Qt::LeftButton) setWindow(m_initialWin);
+    }
+
+    void wheelEvent(QWheelEvent* e) override
+    {
+        if (m_series && !(e->modifiers() & Qt::ControlModifier)) {
+            // um passo por "clique" (120), acumulando deltas de touchpad
+            m_wheelAccum += e->angleDelta().y();
+            const int steps = m_wheelAccum / 120;
+            m_wheelAccum -= steps * 120;
+            if (steps) goToSlice(m_slice - steps, -steps);
+        } else {
+            zoomAt(e->position(), std::pow(1.0015, e->angleDelta().y()));
+        }
+        e->accept();
+    }
+
+    void keyPressEvent(QKeyEvent* e) override
+    {
+        switch (e->key()) {
+        case Qt::Key_R:        resetView(); break;
+        case Qt::Key_A:        if (m_raw) setWindow(m_raw->autoWindow()); break;
+        case Qt::Key_P:        setPerfOverlayVisible(!m_perfOverlay); break;
+        case Qt::Key_Up:       goToSlice(m_slice - 1, -1); break;
+        case Qt::Key_Down:     goToSlice(m_slice + 1, 1); break;
+        case Qt::Key_PageUp:   goToSlice(m_slice - 10, -1); break;
+        case Qt::Key_PageDown: goToSlice(m_slice + 10, 1); break;
+        case Qt::Key_Home:     goToSlice(0, 1); break;
+        case Qt::Key_End:      goToSlice(m_series ? m_series->size() - 1 : 0, -1); break;
+        default:               QWidget::keyPressEvent(e);
         }
     }
 
 private:
-    QImage  m_img;
+    static constexpr int kTileSize = 256;
+    static constexpr double kMinZoom = 0.25;
+    static constexpr double kMaxZoom = 64.0;
+
+    // tile de 8 bits de um nível; gen é a geração da janela com que foi remapeado
+    struct Tile
+    {
+        QImage   img;
+        uint64_t gen = 0;
+    };
+
+    struct Level
+    {
+        std::shared_ptr<const RawImage> raw;
+        int cols = 0;
+        int rows = 0;
+        std::vector<Tile> tiles;
+    };
+
+    enum DragMode { DragNone, DragWindow, DragPan };
+
+    // -------------------- série --------------------
+    // O loader antigo para de chamar callbacks na hora, mas os workers podem
+    // estar no meio de uma decodificação: a destruição (join) vai para outra
+    // thread em vez de travar a GUI. As que já terminaram são juntadas aqui,
+    // a cada troca de série; o destrutor do widget espera as restantes.
+    void retireSeries()
+    {
+        m_retired.reap();
+        if (!m_series) return;
+        m_series->shutdown();
+        // shared_ptr só porque std::function exige cópia; a única referência
+        // fica com a tarefa, então o destrutor roda na thread dela
+        std::shared_ptr<SeriesLoader> old(std::move(m_series));
+        m_retired.run([old = std::move(old)]() mutable { old.reset(); });
+    }
+
+    void goToSlice(int index, int direction)
+    {
+        if (!m_series || m_series->size() == 0) return;
+        m_slice = std::max(0, std::min(m_series->size() - 1, index));
+        m_series->request(m_slice, direction);
+        showSliceIfReady();
+        update();
+    }
+
+    // m_shownSlice é a fatia cujos pixels estão na tela; uma miniatura no lugar
+    // deles zera o valor, para a volta a essa fatia reinstalar a pirâmide.
+    void showSliceIfReady()
+    {
+        if (m_shownSlice == m_slice) return;
+        RawPyramid levels = m_series->get(m_slice);
+        if (levels.empty()) {
+            const Thumbnail t = m_series->preview(m_slice);
+            if (t) {
+                setPreview(Gray8FrameToQImage(t.frame), QSize(t.sourceWidth, t.sourceHeight));
+                m_shownSlice = -1;
+            }
+            return;
+        }
+        setRawPyramid(levels, m_seriesShown);
+        m_shownSlice = m_slice;
+        m_seriesShown = true;
+    }
+
+    void onSliceReady(int index)
+    {
+        if (m_series && index == m_slice) showSliceIfReady();
+    }
+
+    void setWindow(const WindowRange& win)
+    {
+        if (!m_raw || win == m_win) return;
+        m_win = win;
+        m_raw->buildLut(m_lut, m_win);
+        ++m_winGen;
+        invalidateView();
+    }
+
+    void invalidateView()
+    {
+        m_viewValid = false;
+        update();
+    }
+
+    // -------------------- geometria da vista --------------------
+    QSize imageSize() const
+    {
+        if (!m_levels.empty()) return QSize(m_levels[0].raw->width, m_levels[0].raw->height);
+        if (!m_previewSize.isEmpty()) return m_previewSize;
+        return m_img.size();
+    }
+
+    // escala que encaixa a imagem inteira no widget (aspecto preservado)
+    double fitScale() const
+    {
+        const QSize img = imageSize();
+        if (img.isEmpty()) return 1.0;
+        return std::min(static_cast<double>(width())  / img.width(),
+                        static_cast<double>(height()) / img.height());
+    }
+
+    double viewScale() const { return fitScale() * m_zoom; }
+
+    QPointF centeredOrigin(double s) const
+    {
+        const QSize img = imageSize();
+        return QPointF((width()  - img.width()  * s) / 2.0,
+                       (height() - img.height() * s) / 2.0);
+    }
+
+    // canto superior esquerdo da imagem em coordenadas do widget
+    QPointF imageOrigin() const { return centeredOrigin(viewScale()) + m_pan; }
+
+    void zoomAt(const QPointF& c, double factor)
+    {
+        if (imageSize().isEmpty()) return;
+
+        // mantém fixo o ponto da imagem sob o cursor
+        const QPointF imgPt = (c - imageOrigin()) / viewScale();
+        m_zoom = std::max(kMinZoom, std::min(kMaxZoom, m_zoom * factor));
+        const double s = viewScale();
+        m_pan = (c - imgPt * s) - centeredOrigin(s);
+        invalidateView();
+    }
+
+    // nível com resolução >= resolução da tela (deviceScale = px de tela por px da imagem)
+    int pickLevel(double deviceScale) const
+    {
+        if (deviceScale >= 1.0 || m_levels.size() < 2) return 0;
+        const int k = static_cast<int>(std::floor(std::log2(1.0 / deviceScale)));
+        return std::max(0, std::min(static_cast<int>(m_levels.size()) - 1, k));
+    }
+
+    // -------------------- tiles / cache --------------------
+    Tile& tileFor(Level& lvl, int tx, int ty)
+    {
+        Tile& t = lvl.tiles[static_cast<size_t>(ty) * static_cast<size_t>(lvl.cols) + static_cast<size_t>(tx)];
+        if (t.gen != m_winGen) {
+            const QRect src(tx * kTileSize, ty * kTileSize,
+                            std::min(kTileSize, lvl.raw->width  - tx * kTileSize),
+                            std::min(kTileSize, lvl.raw->height - ty * kTileSize));
+            PERF_SCOPE_PIXELS("remap_tile", static_cast<uint64_t>(src.width()) * static_cast<uint64_t>(src.height()));
+            if (t.img.isNull())
+                t.img = QImage(src.width(), src.height(), DisplayFormat(*lvl.raw));
+            RawToDisplayRegion(*lvl.raw, m_lut, src, t.img);
+            t.gen = m_winGen;
+        }
+        return t;
+    }
+
+    void ensureViewCache()
+    {
+        PERF_SCOPE("view_cache");
+        const double dpr = devicePixelRatioF();
+        const QSize devSize(static_cast<int>(std::ceil(width()  * dpr)),
+                            static_cast<int>(std::ceil(height() * dpr)));
+        if (m_viewValid && m_viewCache.size() == devSize) return;
+
+        if (m_viewCache.size() != devSize)
+            m_viewCache = QPixmap(devSize);
+        m_viewCache.setDevicePixelRatio(dpr);
+        m_viewCache.fill(Qt::black);
+
+        QPainter cp(&m_viewCache);
+        cp.setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+        const double s = viewScale();
+        const QPointF o = imageOrigin();
+
+        if (m_levels.empty()) {
+            const QSize img = imageSize();
+            cp.drawImage(QRectF(o.x(), o.y(), img.width() * s, img.height() * s), m_img);
+        } else {
+            Level& lvl = m_levels[static_cast<size_t>(pickLevel(s * dpr))];
+
+            // px do widget por px do nível
+            const double px = s * static_cast<double>(m_levels[0].raw->width)  / lvl.raw->width;
+            const double py = s * static_cast<double>(m_levels[0].raw->height) / lvl.raw->height;
+            const double tw = kTileSize * px;
+            const double th = kTileSize * py;
+
+            const int tx0 = std::max(0, static_cast<int>(std::floor(-o.x() / tw)));
+            const int ty0 = std::max(0, static_cast<int>(std::floor(-o.y() / th)));
+            const int tx1 = std::min(lvl.cols - 1, static_cast<int>(std::floor((width()  - o.x()) / tw)));
+            const int ty1 = std::min(lvl.rows - 1, static_cast<int>(std::floor((height() - o.y()) / th)));
+
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    const Tile& t = tileFor(lvl, tx, ty);
+                    cp.drawImage(QRectF(o.x() + tx * tw, o.y() + ty * th,
+                                        t.img.width() * px, t.img.height() * py), t.img);
+                }
+            }
+        }
+
+        cp.end();
+        m_viewValid = true;
+    }
+
+    // uma linha por etapa: última / média / quantidade (e Mpixel/s nas etapas
+    // que contam pixels); depois os contadores
+    static QString perfText()
+    {
+        const PerfTrace& t = PerfTrace::Instance();
+        QString text;
+        for (const auto& s : t.summary()) {
+            text += QString("%1: %2 ms (média %3 ms, %4x)")
+                        .arg(QString::fromStdString(s.name))
+                        .arg(s.lastMs, 0, 'f', 2)
+                        .arg(s.totalMs / static_cast<double>(s.count), 0, 'f', 2)
+                        .arg(static_cast<long long>(s.count));
+            if (s.pixels && s.totalMs > 0.0)
+                text += QString(" %1 Mpx/s").arg(static_cast<double>(s.pixels) / (s.totalMs * 1e3), 0, 'f', 0);
+            text += "\n";
+        }
+        text += QString("lidos: %1 MB  alocações: %2")
+                    .arg(static_cast<double>(t.counter(PerfBytesRead)) / 1e6, 0, 'f', 1)
+                    .arg(static_cast<long long>(t.counter(PerfAllocations)));
+        return text;
+    }
+
+    void drawShadowText(QPainter& p, int align, const QString& text)
+    {
+        const int margin = 12;
+
+        QFont f = p.font();
+        f.setPointSize(14);
+        f.setBold(true);
+        p.setFont(f);
+
+        QRect overlayRect = rect().adjusted(margin, margin, -margin, -margin);
+
+        // sombra
+        p.setPen(QColor(0,0,0,200));
+        p.drawText(overlayRect.adjusted(2,2,2,2), align, text);
+
+        // texto
+        p.setPen(QColor(255,255,255,230));
+        p.drawText(overlayRect, align, text);
+    }
+
+    QImage  m_img;          // imagem 8 bits pronta (setImage) ou pré-visualização
+    QSize   m_previewSize;  // tamanho da imagem completa quando m_img é pré-visualização
     QString m_overlay;
+    QString m_loading;
+    bool    m_perfOverlay = false;
+    bool    m_perfOwned = false;    // a instrumentação foi ligada pelo overlay
+
+    std::shared_ptr<const RawImage> m_raw;
+    std::vector<Level> m_levels;
+    WindowLut   m_lut;
+    WindowRange m_win;
+    WindowRange m_initialWin;
+    uint64_t    m_winGen = 1;
+
+    double  m_zoom = 1.0;   // relativo ao encaixe na janela
+    QPointF m_pan;          // deslocamento em px do widget
+    QPixmap m_viewCache;    // vista atual na resolução do dispositivo
+    bool    m_viewValid = false;
+
+    std::unique_ptr<SeriesLoader> m_series;
+    BackgroundTasks m_retired;              // destruindo loaders substituídos
+    int m_slice = 0;
+    int m_shownSlice = -1;
+    bool m_seriesShown = false;             // alguma fatia já apareceu: trocas mantêm janela/zoom
+    int m_wheelAccum = 0;
+
+    DragMode    m_drag = DragNone;
+    QPoint      m_dragStart;
+    WindowRange m_dragWin;
+    QPointF     m_dragPan;
 };
 
 
-#endif //READ_DICOM_GDCM_DICOMVIEWWIDGET_H
\ No newline at end of file
+#endif //READ_DICOM_GDCM_DICOMVIEWWIDGET_H
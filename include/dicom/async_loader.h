@@ -0,0 +1,184 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_ASYNC_LOADER_H
+#define READ_DICOM_GDCM_ASYNC_LOADER_H
+#include <gdcmImageReader.h>
+#include <gdcmReader.h>
+
+#include <dicom/dicom_raw.h>
+#include <dicom/dicom_pyramid.h>
+#include <dicom/dicom_scan.h>
+#include <dicom/dicom_cache.h>
+#include <dicom/memory_stream.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// -------------------- abertura de arquivo em segundo plano --------------------
+// Uma thread de trabalho abre um arquivo por vez, em etapas:
+//   1. cabeçalho (até Pixel Data)      -> header()
+//   2. miniatura em disco, se houver   -> preview()
+//   3. leitura do arquivo em blocos    -> progress()
+//   4. ir.Read() + GetBuffer + pirâmide -> done()
+// load() devolve um id e cancela o anterior: a leitura em blocos para no
+// próximo bloco, e o resultado de uma etapa do GDCM já em andamento (que não
+// pode ser interrompida) é descartado. Callbacks rodam na thread de trabalho
+// e nunca são chamados para um id cancelado; quem recebe (GUI) ainda deve
+// conferir o id, porque o cancelamento pode acontecer depois do callback
+// ter sido postado.
+class AsyncImageLoader
+{
+public:
+    struct Callbacks
+    {
+        std::function<void(uint64_t id, const gdcm::DataSet& header)> header;
+        std::function<void(uint64_t id, const Thumbnail& preview)> preview;
+        std::function<void(uint64_t id, const char* stage, double fraction)> progress;
+        // levels vazio = falha (error diz o motivo)
+        std::function<void(uint64_t id, const RawPyramid& levels, const std::string& error)> done;
+    };
+
+    explicit AsyncImageLoader(Callbacks cb, FrameCache* cache = nullptr,
+                              const ThumbnailStore* thumbs = nullptr)
+        : m_cb(std::move(cb)), m_cache(cache), m_thumbs(thumbs)
+    {
+        m_worker = std::thread([this]{ workerLoop(); });
+    }
+
+    ~AsyncImageLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_stop = true;
+        }
+        m_current.fetch_add(1);   // cancela o que estiver em andamento
+        m_wake.notify_all();
+        m_worker.join();
+    }
+
+    // não bloqueia
+    uint64_t load(const std::string& path)
+    {
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            id = m_current.fetch_add(1) + 1;
+            m_pendingPath = path;
+            m_pendingId = id;
+        }
+        m_wake.notify_all();
+        return id;
+    }
+
+    void cancel() { m_current.fetch_add(1); }
+
+    bool cancelled(uint64_t id) const { return id != m_current.load(); }
+
+private:
+    void workerLoop()
+    {
+        for (;;) {
+            std::string path;
+            uint64_t id = 0;
+            {
+                std::unique_lock<std::mutex> lk(m_mutex);
+                m_wake.wait(lk, [&]{ return m_stop || m_pendingId != 0; });
+                if (m_stop) return;
+                path.swap(m_pendingPath);
+                id = m_pendingId;
+                m_pendingId = 0;
+            }
+            if (!cancelled(id)) run(id, path);
+        }
+    }
+
+    void run(uint64_t id, const std::string& path)
+    {
+        auto fail = [&](const char* why) {
+            if (!cancelled(id) && m_cb.done) m_cb.done(id, RawPyramid(), why);
+        };
+
+        // 1. cabeçalho
+        gdcm::Reader hr;
+        if (!ReadDicomHeader(path, hr)) return fail("Falha ao ler o arquivo DICOM com GDCM.");
+        if (cancelled(id)) return;
+        if (m_cb.header) m_cb.header(id, hr.GetFile().GetDataSet());
+
+        // já decodificado nesta sessão
+        const FileStamp st = StatFile(path);
+        if (m_cache) {
+            RawPyramid hit = m_cache->getRaw(path, st);
+            if (!hit.empty()) {
+                if (!cancelled(id) && m_cb.done) m_cb.done(id, hit, std::string());
+                return;
+            }
+        }
+
+        // 2. pré-visualização de uma abertura anterior
+        bool hasThumb = false;
+        if (m_thumbs) {
+            const Thumbnail t = m_thumbs->load(path, st);
+            hasThumb = static_cast<bool>(t);
+            if (hasThumb && !cancelled(id) && m_cb.preview) m_cb.preview(id, t);
+        }
+
+        // 3. E/S em blocos (cancelável)
+        std::vector<char> bytes;
+        const bool read = ReadFileToBuffer(path, bytes, [&](size_t done, size_t total) {
+            if (cancelled(id)) return false;
+            if (m_cb.progress) m_cb.progress(id, "leitura", total ? double(done) / double(total) : 1.0);
+            return true;
+        });
+        if (cancelled(id)) return;
+        if (!read) return fail("Falha ao ler o arquivo.");
+
+        // 4. decodificação (o GDCM não é interrompível; só descartamos o resultado)
+        if (m_cb.progress) m_cb.progress(id, "decodificação", 0.0);
+        MemoryIStream is(bytes.data(), bytes.size());
+        gdcm::ImageReader ir;
+        ir.SetStream(is);
+        if (!ReadDicomImage(ir)) return fail("Falha ao ler o arquivo DICOM com GDCM.");
+        if (cancelled(id)) return;
+
+        auto raw = std::make_shared<RawImage>();
+        if (!DicomReadRawImage(ir, *raw, 1))
+            return fail("Não consegui converter para imagem.\n"
+                        "Formatos suportados: MONOCHROME1/2 ou RGB, 8/16/32 bits.");
+        std::vector<char>().swap(bytes);
+        if (cancelled(id)) return;
+
+        if (m_cb.progress) m_cb.progress(id, "pirâmide", 0.0);
+        RawPyramid levels = BuildRawPyramid(raw);
+        if (m_cache) m_cache->putRaw(path, st, levels);
+        if (cancelled(id)) return;
+        if (m_cb.done) m_cb.done(id, levels, std::string());
+
+        if (m_thumbs && !hasThumb)
+            m_thumbs->save(path, st, m_thumbs->render(levels, levels.back()->defaultWindow()));
+    }
+
+    const Callbacks m_cb;
+    FrameCache* const m_cache;
+    const ThumbnailStore* const m_thumbs;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::string m_pendingPath;
+    uint64_t    m_pendingId = 0;
+    bool        m_stop = false;
+    std::atomic<uint64_t> m_current{0};
+
+    std::thread m_worker;
+};
+
+#endif //READ_DICOM_GDCM_ASYNC_LOADER_H
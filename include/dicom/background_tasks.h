@@ -0,0 +1,71 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_BACKGROUND_TASKS_H
+#define READ_DICOM_GDCM_BACKGROUND_TASKS_H
+
+#include <vector>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <utility>
+
+// -------------------- tarefas avulsas em segundo plano --------------------
+// Trabalhos de uma vez só que não podem travar a GUI (ler os cabeçalhos de
+// uma pasta, destruir um loader que ainda decodifica). Cada run() primeiro
+// junta as threads que já terminaram, então o vetor não cresce com o uso;
+// o destrutor espera as que ainda rodam. Usada por uma única thread (a GUI).
+class BackgroundTasks
+{
+public:
+    BackgroundTasks() = default;
+    BackgroundTasks(const BackgroundTasks&) = delete;
+    BackgroundTasks& operator=(const BackgroundTasks&) = delete;
+
+    ~BackgroundTasks() { waitAll(); }
+
+    void run(std::function<void()> fn)
+    {
+        reap();
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        std::thread t([fn = std::move(fn), done]{
+            fn();
+            done->store(true);
+        });
+        m_tasks.push_back(Task{ std::move(t), std::move(done) });
+    }
+
+    // junta (sem esperar) as que já terminaram
+    void reap()
+    {
+        for (auto it = m_tasks.begin(); it != m_tasks.end(); ) {
+            if (it->done->load()) {
+                it->thread.join();
+                it = m_tasks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void waitAll()
+    {
+        for (auto& t : m_tasks) t.thread.join();
+        m_tasks.clear();
+    }
+
+    size_t pending() const { return m_tasks.size(); }
+
+private:
+    struct Task
+    {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    std::vector<Task> m_tasks;
+};
+
+#endif //READ_DICOM_GDCM_BACKGROUND_TASKS_H
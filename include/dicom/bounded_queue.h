@@ -0,0 +1,74 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_BOUNDED_QUEUE_H
+#define READ_DICOM_GDCM_BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <utility>
+
+// -------------------- fila limitada entre estágios --------------------
+// push() bloqueia quando a fila está cheia (limita a memória em voo);
+// pop() bloqueia até haver item ou a fila ser fechada e esvaziada.
+// Cada produtor chama close() ao terminar; a fila fecha quando todos fecharem.
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity, int producers = 1)
+        : m_capacity(capacity ? capacity : 1), m_producers(producers) {}
+
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_notFull.wait(lk, [&]{ return m_items.size() < m_capacity || m_cancelled; });
+        if (m_cancelled) return false;
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T& out)
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_notEmpty.wait(lk, [&]{ return !m_items.empty() || m_producers == 0 || m_cancelled; });
+        if (m_items.empty() || m_cancelled) return false;
+        out = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // um produtor terminou
+    void close()
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_producers > 0 && --m_producers == 0)
+            m_notEmpty.notify_all();
+    }
+
+    // descarta o que está na fila e acorda todos (produtores e consumidores)
+    void cancel()
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_cancelled = true;
+        m_items.clear();
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<T> m_items;
+    size_t m_capacity;
+    int    m_producers;
+    bool   m_cancelled = false;
+};
+
+#endif //READ_DICOM_GDCM_BOUNDED_QUEUE_H
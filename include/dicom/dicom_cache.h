@@ -0,0 +1,379 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_CACHE_H
+#define READ_DICOM_GDCM_DICOM_CACHE_H
+#include <gdcmImageReader.h>
+
+#include <dicom/dicom_raw.h>
+#include <dicom/dicom_lut.h>
+#include <dicom/dicom_pyramid.h>
+#include <dicom/pixel_pool.h>
+#include <dicom/file_io.h>
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+// -------------------- frame de 8 bits (sem Qt) --------------------
+struct Gray8Frame
+{
+    int    width = 0;
+    int    height = 0;
+    size_t stride = 0;
+    PixelBuffer pixels;
+
+    bool isNull() const { return pixels.empty(); }
+    const uint8_t* row(int y) const
+    {
+        return reinterpret_cast<const uint8_t*>(pixels.data()) + static_cast<size_t>(y) * stride;
+    }
+};
+
+static std::shared_ptr<Gray8Frame> RenderGray8Frame(const RawImage& raw, const WindowRange& win)
+{
+    WindowLut lut;
+    if (!raw.buildLut(lut, win)) return nullptr;
+
+    auto f = std::make_shared<Gray8Frame>();
+    f->width = raw.width;
+    f->height = raw.height;
+    f->stride = (static_cast<size_t>(raw.width) + 63) & ~static_cast<size_t>(63);
+    f->pixels = PixelBuffer::Allocate(f->stride * static_cast<size_t>(raw.height));
+    if (f->pixels.empty()) return nullptr;
+    WindowToGray8(raw.pixels.data(), raw.width, raw.height, raw.bitsAllocated, lut,
+                  reinterpret_cast<uint8_t*>(f->pixels.data()), f->stride, raw.samplesPerPixel);
+    return f;
+}
+
+// -------------------- cache LRU em memória --------------------
+// Pirâmides cruas num orçamento de bytes; ao passar do orçamento saem as
+// entradas usadas há mais tempo.
+class FrameCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t bytes = 0;
+        size_t entries = 0;
+    };
+
+    explicit FrameCache(size_t budgetBytes = size_t(1) << 30) : m_budget(budgetBytes) {}
+
+    void setBudget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_budget = bytes;
+        evictLocked();
+    }
+
+    RawPyramid getRaw(const std::string& path, const FileStamp& st)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        Entry* e = findLocked(RawKey(path, st));
+        return e ? e->raw : RawPyramid();
+    }
+
+    void putRaw(const std::string& path, const FileStamp& st, const RawPyramid& levels)
+    {
+        if (!st.valid || levels.empty()) return;
+        Entry e;
+        e.raw = levels;
+        for (const auto& l : levels) e.bytes += l->pixels.capacity();
+        std::lock_guard<std::mutex> lk(m_mutex);
+        insertLocked(RawKey(path, st), std::move(e));
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_lru.clear();
+        m_index.clear();
+        m_stats.bytes = 0;
+    }
+
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        Stats s = m_stats;
+        s.entries = m_lru.size();
+        return s;
+    }
+
+private:
+    struct Entry
+    {
+        std::string key;
+        RawPyramid  raw;
+        size_t      bytes = 0;
+    };
+    typedef std::list<Entry> List;
+
+    static std::string RawKey(const std::string& path, const FileStamp& st)
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "|%lld|%llu",
+                      static_cast<long long>(st.mtime), static_cast<unsigned long long>(st.size));
+        return path + buf;
+    }
+
+    Entry* findLocked(const std::string& key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end()) { ++m_stats.misses; return nullptr; }
+        m_lru.splice(m_lru.begin(), m_lru, it->second);   // mais recente na frente
+        ++m_stats.hits;
+        return &*it->second;
+    }
+
+    void insertLocked(std::string key, Entry e)
+    {
+        auto old = m_index.find(key);
+        if (old != m_index.end()) {
+            m_stats.bytes -= old->second->bytes;
+            m_lru.erase(old->second);
+            m_index.erase(old);
+        }
+        e.key = key;
+        m_stats.bytes += e.bytes;
+        m_lru.push_front(std::move(e));
+        m_index.emplace(std::move(key), m_lru.begin());
+        evictLocked();
+    }
+
+    void evictLocked()
+    {
+        // a entrada recém-inserida fica mesmo se sozinha passar do orçamento
+        while (m_stats.bytes > m_budget && m_lru.size() > 1) {
+            Entry& e = m_lru.back();
+            m_stats.bytes -= e.bytes;
+            m_index.erase(e.key);
+            m_lru.pop_back();
+            ++m_stats.evictions;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    List   m_lru;
+    std::unordered_map<std::string, List::iterator> m_index;
+    size_t m_budget;
+    Stats  m_stats;
+};
+
+// Decodifica (ou pega do cache) a pirâmide crua de um arquivo.
+static RawPyramid LoadRawPyramidCached(FrameCache* cache, const std::string& path, int statsThreads = 0)
+{
+    const FileStamp st = StatFile(path);
+    if (cache) {
+        RawPyramid hit = cache->getRaw(path, st);
+        if (!hit.empty()) return hit;
+    }
+
+    gdcm::ImageReader ir;
+    ir.SetFileName(path.c_str());
+    auto raw = std::make_shared<RawImage>();
+    if (!ReadDicomImage(ir) || !DicomReadRawImage(ir, *raw, statsThreads)) return RawPyramid();
+
+    RawPyramid levels = BuildRawPyramid(raw);
+    if (cache) cache->putRaw(path, st, levels);
+    return levels;
+}
+
+// -------------------- miniaturas em disco --------------------
+// Miniatura + tamanho da imagem original (para desenhá-la no lugar dela).
+struct Thumbnail
+{
+    std::shared_ptr<const Gray8Frame> frame;
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+
+    explicit operator bool() const { return frame && !frame->isNull(); }
+};
+
+// Um arquivo por imagem, nome = hash(caminho), validado por mtime/tamanho:
+//   "DTHM" | u32 versão | i64 mtime | u64 tamanho | u32 len + caminho |
+//   u32 largura/altura originais | u16 largura | u16 altura | pixels 8 bits
+// Sobrevive a reinícios; prune() limita o espaço usado, apagando primeiro as
+// usadas há mais tempo (load() atualiza a data do arquivo).
+class ThumbnailStore
+{
+public:
+    explicit ThumbnailStore(std::string dir, int maxSide = 256)
+        : m_dir(std::move(dir)), m_maxSide(maxSide)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(m_dir, ec);
+    }
+
+    int maxSide() const { return m_maxSide; }
+
+    Thumbnail load(const std::string& path, const FileStamp& st) const
+    {
+        if (!st.valid) return {};
+        std::ifstream in(fileFor(path), std::ios::binary);
+        if (!in) return {};
+
+        char magic[4];
+        uint32_t version = 0;
+        int64_t mtime = 0;
+        uint64_t size = 0;
+        if (!in.read(magic, 4) || std::memcmp(magic, "DTHM", 4) != 0) return {};
+        if (!GetBinary(in, version) || version != kVersion) return {};
+        if (!GetBinary(in, mtime) || !GetBinary(in, size) || mtime != st.mtime || size != st.size) return {};
+        std::string stored;
+        if (!GetBinaryString(in, stored, static_cast<uint32_t>(path.size())) || stored != path) return {};   // colisão de hash
+
+        uint32_t sw = 0, sh = 0;
+        uint16_t w = 0, h = 0;
+        if (!GetBinary(in, sw) || !GetBinary(in, sh) || !GetBinary(in, w) || !GetBinary(in, h) || w == 0 || h == 0) return {};
+
+        auto f = std::make_shared<Gray8Frame>();
+        f->width = w;
+        f->height = h;
+        f->stride = w;
+        f->pixels = PixelBuffer::Allocate(static_cast<size_t>(w) * h);
+        if (f->pixels.empty() || !in.read(f->pixels.data(), static_cast<std::streamsize>(f->pixels.size()))) return {};
+
+        Thumbnail t;
+        t.frame = std::move(f);
+        t.sourceWidth = static_cast<int>(sw);
+        t.sourceHeight = static_cast<int>(sh);
+
+        // marca o uso para prune() (LRU pela data do arquivo)
+        std::error_code ec;
+        std::filesystem::last_write_time(fileFor(path), std::filesystem::file_time_type::clock::now(), ec);
+        return t;
+    }
+
+    bool save(const std::string& path, const FileStamp& st, const Thumbnail& t) const
+    {
+        if (!st.valid || !t) return false;
+        const Gray8Frame& f = *t.frame;
+        if (f.width > 0xFFFF || f.height > 0xFFFF) return false;
+        const std::string file = fileFor(path);
+        const std::string tmp = tempFor(file);
+
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write("DTHM", 4);
+        PutBinary(out, kVersion);
+        PutBinary(out, st.mtime);
+        PutBinary(out, st.size);
+        PutBinaryString(out, path);
+        PutBinary(out, static_cast<uint32_t>(t.sourceWidth));
+        PutBinary(out, static_cast<uint32_t>(t.sourceHeight));
+        PutBinary(out, static_cast<uint16_t>(f.width));
+        PutBinary(out, static_cast<uint16_t>(f.height));
+        for (int y = 0; y < f.height; ++y)
+            out.write(reinterpret_cast<const char*>(f.row(y)), f.width);
+        // close() faz o último flush: só um arquivo completo é renomeado
+        out.close();
+        if (!out) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, file, ec);
+        if (ec) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Miniatura a partir da pirâmide: primeiro nível com lado <= maxSide.
+    Thumbnail render(const RawPyramid& levels, const WindowRange& win) const
+    {
+        if (levels.empty()) return {};
+        const RawImage* src = levels.back().get();
+        for (const auto& l : levels)
+            if (std::max(l->width, l->height) <= m_maxSide) { src = l.get(); break; }
+
+        Thumbnail t;
+        t.frame = RenderGray8Frame(*src, win);
+        t.sourceWidth = levels[0]->width;
+        t.sourceHeight = levels[0]->height;
+        return t;
+    }
+
+    // Apaga as miniaturas usadas há mais tempo até o total caber em maxBytes,
+    // e temporários de gravações interrompidas com mais de uma hora.
+    void prune(uint64_t maxBytes) const
+    {
+        namespace fs = std::filesystem;
+        struct Item { fs::path p; fs::file_time_type t; uint64_t size; };
+        std::vector<Item> items;
+        uint64_t total = 0;
+        std::error_code ec;
+        const auto staleTmp = fs::file_time_type::clock::now() - std::chrono::hours(1);
+        for (const auto& de : fs::directory_iterator(m_dir, ec)) {
+            if (!de.is_regular_file(ec)) continue;
+            if (de.path().extension() == ".tmp") {
+                if (de.last_write_time(ec) < staleTmp) fs::remove(de.path(), ec);
+                continue;
+            }
+            if (de.path().extension() != ".thm") continue;
+            Item it{ de.path(), de.last_write_time(ec), de.file_size(ec) };
+            total += it.size;
+            items.push_back(std::move(it));
+        }
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b){ return a.t < b.t; });
+        for (const auto& it : items) {
+            if (total <= maxBytes) break;
+            if (fs::remove(it.p, ec)) total -= it.size;
+        }
+    }
+
+private:
+    static constexpr uint32_t kVersion = 1;
+
+    std::string fileFor(const std::string& path) const
+    {
+        // FNV-1a 64
+        uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : path) { h ^= c; h *= 1099511628211ull; }
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.thm", static_cast<unsigned long long>(h));
+        return (std::filesystem::path(m_dir) / name).string();
+    }
+
+    // Temporário único por gravação: várias threads e vários processos podem
+    // gravar a mesma miniatura ao mesmo tempo; cada um renomeia o seu arquivo
+    // completo, e o último vence.
+    static std::string tempFor(const std::string& file)
+    {
+        static const uint64_t process = (static_cast<uint64_t>(std::random_device{}()) << 32)
+            ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        static std::atomic<uint64_t> counter{0};
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), ".%016llx.%llu.%llu.tmp",
+                      static_cast<unsigned long long>(process),
+                      static_cast<unsigned long long>(std::hash<std::thread::id>()(std::this_thread::get_id())),
+                      static_cast<unsigned long long>(counter.fetch_add(1)));
+        return file + buf;
+    }
+
+    std::string m_dir;
+    int m_maxSide;
+};
+
+#endif //READ_DICOM_GDCM_DICOM_CACHE_H
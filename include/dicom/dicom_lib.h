@@ -14,146 +14,95 @@
 #include <gdcmAttribute.h>
 
 #include <QImage>
-// -------------------- helpers DICOM tags --------------------
-static bool TryGetDSString(const gdcm::DataSet& ds, uint16_t g, uint16_t e, std::string& out)
-{
-    gdcm::Tag tag(g, e);
-    if (!ds.FindDataElement(tag)) return false;
 
-    const gdcm::DataElement& de = ds.GetDataElement(tag);
-    const gdcm::ByteValue* bv = de.GetByteValue();
-    if (!bv) return false;
+#include <dicom/dicom_lut.h>
+#include <dicom/dicom_raw.h>
+#include <dicom/dicom_cache.h>
 
-    out.assign(bv->GetPointer(), bv->GetLength());
-    while (!out.empty() && (out.back() == '\0' || out.back() == ' ' || out.back() == '\r' || out.back() == '\n'))
-        out.pop_back();
-    return true;
+// -------------------- RawImage -> QImage --------------------
+// Formato de exibição: Grayscale8 (monocromática) ou RGB888 (janela por canal).
+static QImage::Format DisplayFormat(const RawImage& raw)
+{
+    return raw.isColor() ? QImage::Format_RGB888 : QImage::Format_Grayscale8;
 }
 
-static bool ParseDouble(const std::string& s, double& v)
+// Remapeia só o retângulo src (coordenadas da imagem crua) e escreve em out
+// (no formato de DisplayFormat) a partir de dstPos. Usado para atualizar
+// tiles sem tocar no resto.
+static void RawToDisplayRegion(const RawImage& raw, const WindowLut& lut, const QRect& src,
+                               QImage& out, const QPoint& dstPos = QPoint())
 {
-    try {
-        size_t idx = 0;
-        v = std::stod(s, &idx);
-        return idx > 0;
-    } catch (...) { return false; }
+    const int x0 = std::max(0, src.left());
+    const int y0 = std::max(0, src.top());
+    const int x1 = std::min({raw.width,  src.left() + src.width(),  x0 + out.width()  - dstPos.x()});
+    const int y1 = std::min({raw.height, src.top() + src.height(), y0 + out.height() - dstPos.y()});
+    if (x1 <= x0 || y1 <= y0) return;
+
+    const size_t spp = static_cast<size_t>(raw.samplesPerPixel);
+    RawToDisplayRows(raw, lut, x0, y0, x1, y1,
+                     out.scanLine(dstPos.y()) + static_cast<size_t>(dstPos.x()) * spp,
+                     static_cast<size_t>(out.bytesPerLine()));
 }
 
-// -------------------- DICOM -> QImage (Grayscale8) --------------------
-static QImage DicomToQImage_Grayscale8(gdcm::ImageReader& ir)
+// -------------------- QImage sobre memória do pool --------------------
+static void ReleasePooledImage(void* info)
 {
-    const gdcm::Image& img = ir.GetImage();
-    const gdcm::File& file = ir.GetFile();
-    const gdcm::DataSet& ds = file.GetDataSet();
-
-    std::array<const unsigned int*,3> dims;
-    dims.fill(img.GetDimensions());
-    const int w = static_cast<int>(*dims[0]);
-    const int h = static_cast<int>(*dims[1]);
-
-    const size_t len = img.GetBufferLength();
-    std::vector<char> buffer(len);
-    if (!img.GetBuffer(buffer.data()))
-        return QImage();
-
-    const auto pf = img.GetPixelFormat();
-    const int bitsAllocated = pf.GetBitsAllocated();
-    const bool isSigned = pf.GetPixelRepresentation() == gdcm::PixelFormat::INT64;
-    const int samplesPerPixel = pf.GetSamplesPerPixel();
+    delete static_cast<PixelBuffer*>(info);
+}
 
-    if (samplesPerPixel != 1) {
-        // Este exemplo foca em grayscale (1 canal)
-        return QImage();
-    }
-    if (!(bitsAllocated == 8 || bitsAllocated == 16)) {
+// QImage Grayscale8 que usa um bloco do PixelBufferPool como memória (sem
+// cópia); o bloco volta ao pool quando a última cópia do QImage é destruída.
+// Linhas alinhadas em 64 bytes.
+static QImage PooledQImage_Grayscale8(int w, int h)
+{
+    const size_t stride = (static_cast<size_t>(w) + 63) & ~static_cast<size_t>(63);
+    auto* buf = new PixelBuffer(PixelBuffer::Allocate(stride * static_cast<size_t>(h)));
+    if (buf->empty()) {
+        delete buf;
         return QImage();
     }
+    return QImage(reinterpret_cast<uchar*>(buf->data()), w, h, static_cast<int>(stride),
+                  QImage::Format_Grayscale8, ReleasePooledImage, buf);
+}
 
-    // Window Center/Width (0028,1050)/(0028,1051)
-    double wc = 0.0, ww = 0.0;
-    bool hasWL = false;
-    {
-        std::string sWC, sWW;
-        if (TryGetDSString(ds, 0x0028, 0x1050, sWC) && TryGetDSString(ds, 0x0028, 0x1051, sWW)) {
-            auto first = [](std::string x){
-                auto p = x.find('\\');
-                if (p != std::string::npos) x = x.substr(0, p);
-                return x;
-            };
-            sWC = first(sWC);
-            sWW = first(sWW);
-
-            double tWC=0, tWW=0;
-            if (ParseDouble(sWC, tWC) && ParseDouble(sWW, tWW) && tWW > 1e-9) {
-                wc = tWC; ww = tWW;
-                hasWL = true;
-            }
-        }
-    }
+static void ReleaseSharedFrame(void* info)
+{
+    delete static_cast<std::shared_ptr<const Gray8Frame>*>(info);
+}
 
-    QImage out(w, h, QImage::Format_Grayscale8);
+// QImage somente leitura sobre um Gray8Frame (do cache ou de uma miniatura),
+// sem cópia; o frame vive enquanto houver uma cópia do QImage.
+static QImage Gray8FrameToQImage(std::shared_ptr<const Gray8Frame> frame)
+{
+    if (!frame || frame->isNull()) return QImage();
+    auto* keep = new std::shared_ptr<const Gray8Frame>(std::move(frame));
+    const Gray8Frame& f = **keep;
+    return QImage(reinterpret_cast<const uchar*>(f.pixels.data()), f.width, f.height,
+                  static_cast<int>(f.stride), QImage::Format_Grayscale8, ReleaseSharedFrame, keep);
+}
+
+static QImage RawToQImage_Grayscale8(const RawImage& raw, const WindowLut& lut)
+{
+    QImage out = PooledQImage_Grayscale8(raw.width, raw.height);
     if (out.isNull()) return QImage();
 
-    auto clamp255 = [](int x){ return static_cast<uchar>(std::max(0, std::min(255, x))); };
-
-    auto mapWL = [&](double p)->uchar {
-        const double low  = wc - ww / 2.0;
-        const double high = wc + ww / 2.0;
-        if (p <= low) return 0;
-        if (p >= high) return 255;
-        const double t = (p - low) / (high - low);
-        return clamp255(static_cast<int>(std::lround(t * 255.0)));
-    };
-
-    double minV = 0.0, maxV = 0.0;
-    if (!hasWL) {
-        minV =  1e300; maxV = -1e300;
-        auto upd = [&](double v){ minV = std::min(minV, v); maxV = std::max(maxV, v); };
-
-        if (bitsAllocated == 8) {
-            const uint8_t* px = reinterpret_cast<const uint8_t*>(buffer.data());
-            for (int i=0;i<w*h;++i) upd(px[i]);
-        } else {
-            if (isSigned) {
-                const int16_t* px = reinterpret_cast<const int16_t*>(buffer.data());
-                for (int i=0;i<w*h;++i) upd(px[i]);
-            } else {
-                const uint16_t* px = reinterpret_cast<const uint16_t*>(buffer.data());
-                for (int i=0;i<w*h;++i) upd(px[i]);
-            }
-        }
-        if (!(maxV > minV)) maxV = minV + 1.0;
-    }
+    WindowToGray8(raw.pixels.data(), raw.width, raw.height, raw.bitsAllocated, lut,
+                  out.bits(), static_cast<size_t>(out.bytesPerLine()), raw.samplesPerPixel);
+    return out;
+}
 
-    auto mapMinMax = [&](double p)->uchar {
-        const double t = (p - minV) / (maxV - minV);
-        return clamp255(static_cast<int>(std::lround(t * 255.0)));
-    };
-
-    for (int y=0;y<h;++y) {
-        uchar* row = out.scanLine(y);
-        for (int x=0;x<w;++x) {
-            const int idx = y*w + x;
-            double p = 0.0;
-
-            if (bitsAllocated == 8) {
-                const uint8_t* px = reinterpret_cast<const uint8_t*>(buffer.data());
-                p = px[idx];
-            } else {
-                if (isSigned) {
-                    const int16_t* px = reinterpret_cast<const int16_t*>(buffer.data());
-                    p = px[idx];
-                } else {
-                    const uint16_t* px = reinterpret_cast<const uint16_t*>(buffer.data());
-                    p = px[idx];
-                }
-            }
-
-            row[x] = hasWL ? mapWL(p) : mapMinMax(p);
-        }
-    }
+// -------------------- DICOM -> QImage (Grayscale8) --------------------
+static QImage DicomToQImage_Grayscale8(gdcm::ImageReader& ir)
+{
+    RawImage raw;
+    if (!DicomReadRawImage(ir, raw, 1))
+        return QImage();
 
-    return out;
+    WindowLut lut;
+    if (!raw.buildLut(lut, raw.defaultWindow()))
+        return QImage();
+
+    return RawToQImage_Grayscale8(raw, lut);
 }
 
 
@@ -168,4 +117,4 @@ static std::string GetStringTag(const gdcm::DataSet& ds, uint16_t group, uint16_
 
     return std::string(bv->GetPointer(), bv->GetLength());
 }
-#endif //READ_DICOM_GDCM_DICOM_LIB_H
\ No newline at end of file
+#endif //READ_DICOM_GDCM_DICOM_LIB_H
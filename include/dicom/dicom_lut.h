@@ -0,0 +1,211 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_LUT_H
+#define READ_DICOM_GDCM_DICOM_LUT_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+#include <dicom/pixel_kernels.h>
+#include <dicom/perf_trace.h>
+
+// -------------------- Janela (window/level) --------------------
+// Faixa [low, high] de valores de modalidade (após slope/intercept) que é
+// mapeada linearmente em 0..255. Valores <= low viram 0 e >= high viram 255.
+struct WindowRange
+{
+    double low  = 0.0;
+    double high = 1.0;
+
+    bool operator==(const WindowRange& o) const { return low == o.low && high == o.high; }
+    bool operator!=(const WindowRange& o) const { return !(*this == o); }
+};
+
+static WindowRange WindowFromCenterWidth(double wc, double ww)
+{
+    return { wc - ww / 2.0, wc + ww / 2.0 };
+}
+
+// Transformações aplicadas antes/depois da janela, embutidas na LUT:
+// Modality LUT linear (0028,1053)/(0028,1052) e inversão de MONOCHROME1.
+struct SampleTransform
+{
+    double slope = 1.0;
+    double intercept = 0.0;
+    bool   invert = false;
+
+    bool identity() const { return slope == 1.0 && intercept == 0.0 && !invert; }
+    double modality(double stored) const { return stored * slope + intercept; }
+
+    bool operator==(const SampleTransform& o) const
+    {
+        return slope == o.slope && intercept == o.intercept && invert == o.invert;
+    }
+};
+
+// -------------------- kernels --------------------
+// Aplica a LUT sem desvios no laço: um acesso à tabela por pixel.
+// Desenrolado de 8 em 8 para o compilador intercalar as leituras.
+template<typename T>
+static inline void ApplyLutKernel(const T* __restrict src, uint8_t* __restrict dst,
+                                  size_t n, const uint8_t* __restrict lut)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        dst[i+0] = lut[src[i+0]];
+        dst[i+1] = lut[src[i+1]];
+        dst[i+2] = lut[src[i+2]];
+        dst[i+3] = lut[src[i+3]];
+        dst[i+4] = lut[src[i+4]];
+        dst[i+5] = lut[src[i+5]];
+        dst[i+6] = lut[src[i+6]];
+        dst[i+7] = lut[src[i+7]];
+    }
+    for (; i < n; ++i)
+        dst[i] = lut[src[i]];
+}
+
+// min/max em aritmética inteira (vetorizável), sem passar por double.
+template<typename T>
+static inline void MinMaxKernel(const T* __restrict px, size_t n, T& outMin, T& outMax)
+{
+    T mn = n ? px[0] : T(0);
+    T mx = mn;
+    for (size_t i = 0; i < n; ++i) {
+        mn = px[i] < mn ? px[i] : mn;
+        mx = px[i] > mx ? px[i] : mx;
+    }
+    outMin = mn;
+    outMax = mx;
+}
+
+// -------------------- LUT de 8 bits --------------------
+// Tabela pré-calculada por ajuste de janela: 256 entradas para 8 bits e
+// 65536 para 16 bits. O índice é o padrão de bits armazenado; com sinal,
+// o índice é reinterpretado como complemento de dois ao montar a tabela.
+// Slope/intercept e inversão entram na tabela, sem custo por pixel.
+// Em 32 bits não há tabela: apply() usa WindowKernel com os mesmos parâmetros.
+class WindowLut
+{
+public:
+    // Retorna false para profundidades não suportadas.
+    bool build(int bitsAllocated, bool isSigned, const WindowRange& win,
+               const SampleTransform& xf = SampleTransform())
+    {
+        if (!(bitsAllocated == 8 || bitsAllocated == 16 || bitsAllocated == 32)) return false;
+        if (bitsAllocated == m_bits && isSigned == m_signed && win == m_win && xf == m_xf
+            && (bitsAllocated == 32 || !m_table.empty()))
+            return true;
+
+        m_bits = bitsAllocated;
+        m_signed = isSigned;
+        m_win = win;
+        m_xf = xf;
+        if (bitsAllocated == 32) {
+            std::vector<uint8_t>().swap(m_table);
+            return true;
+        }
+
+        const size_t n = size_t(1) << bitsAllocated;
+        const double half = static_cast<double>(n / 2);
+        m_table.resize(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            double p = static_cast<double>(i);
+            if (isSigned && p >= half) p -= static_cast<double>(n);
+
+            const uint8_t o = WindowValue(xf.modality(p), win.low, win.high);
+            m_table[i] = xf.invert ? static_cast<uint8_t>(255 - o) : o;
+        }
+        return true;
+    }
+
+    // src aponta para n amostras de bitsAllocated bits (como em build()).
+    void apply(const void* src, uint8_t* dst, size_t n) const
+    {
+        if (m_bits == 8)
+            ApplyLutKernel(static_cast<const uint8_t*>(src), dst, n, m_table.data());
+        else if (m_bits == 16)
+            ApplyLutKernel(static_cast<const uint16_t*>(src), dst, n, m_table.data());
+        else if (m_signed)
+            apply32(static_cast<const int32_t*>(src), dst, n);
+        else
+            apply32(static_cast<const uint32_t*>(src), dst, n);
+    }
+
+    const uint8_t* data() const { return m_table.data(); }
+    size_t size() const { return m_table.size(); }
+    int bitsAllocated() const { return m_bits; }
+    const WindowRange& window() const { return m_win; }
+    const SampleTransform& transform() const { return m_xf; }
+
+private:
+    template<typename T>
+    void apply32(const T* src, uint8_t* dst, size_t n) const
+    {
+        if (m_xf.invert)
+            WindowKernel<T, true>(src, dst, n, m_xf.slope, m_xf.intercept, m_win.low, m_win.high);
+        else
+            WindowKernel<T, false>(src, dst, n, m_xf.slope, m_xf.intercept, m_win.low, m_win.high);
+    }
+
+    std::vector<uint8_t> m_table;
+    int  m_bits = 0;
+    bool m_signed = false;
+    WindowRange     m_win;
+    SampleTransform m_xf;
+};
+
+// -------------------- janela automática (min/max) --------------------
+// Em valores armazenados; quem tem slope/intercept converte depois.
+static WindowRange MinMaxWindow(const void* px, size_t n, int bitsAllocated, bool isSigned)
+{
+    PERF_SCOPE("minmax");
+    double minV = 0.0, maxV = 0.0;
+    DispatchSample(bitsAllocated, isSigned, [&](auto tag) {
+        typedef decltype(tag) T;
+        T mn, mx;
+        MinMaxKernel(static_cast<const T*>(px), n, mn, mx);
+        minV = mn; maxV = mx;
+    });
+    if (!(maxV > minV)) maxV = minV + 1.0;
+    return { minV, maxV };
+}
+
+// -------------------- buffer cru -> 8 bits --------------------
+// Converte w x h pixels linha a linha; dstStride em bytes permite escrever
+// direto em scanlines com padding (ex.: QImage). Com 3 amostras por pixel
+// (RGB intercalado) a janela vale por canal e a saída é a luma.
+static void WindowToGray8(const void* src, int w, int h, int bitsAllocated,
+                          const WindowLut& lut, uint8_t* dst, size_t dstStride,
+                          int samplesPerPixel = 1)
+{
+    const size_t bpp = static_cast<size_t>(bitsAllocated / 8);
+    const size_t spp = static_cast<size_t>(samplesPerPixel);
+    const size_t rowBytes = static_cast<size_t>(w) * spp * bpp;
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    PERF_SCOPE_PIXELS("remap", static_cast<uint64_t>(w) * static_cast<uint64_t>(h));
+
+    if (spp == 3) {
+        std::vector<uint8_t> rgb(static_cast<size_t>(w) * 3);
+        for (int y = 0; y < h; ++y) {
+            lut.apply(s + static_cast<size_t>(y) * rowBytes, rgb.data(), rgb.size());
+            RgbToLumaKernel(rgb.data(), dst + static_cast<size_t>(y) * dstStride, static_cast<size_t>(w));
+        }
+        return;
+    }
+    if (dstStride == static_cast<size_t>(w)) {
+        lut.apply(s, dst, static_cast<size_t>(w) * static_cast<size_t>(h));
+        return;
+    }
+    for (int y = 0; y < h; ++y)
+        lut.apply(s + static_cast<size_t>(y) * rowBytes, dst + static_cast<size_t>(y) * dstStride,
+                  static_cast<size_t>(w));
+}
+
+#endif //READ_DICOM_GDCM_DICOM_LUT_H
@@ -0,0 +1,96 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_PYRAMID_H
+#define READ_DICOM_GDCM_DICOM_PYRAMID_H
+
+#include <dicom/dicom_raw.h>
+#include <dicom/perf_trace.h>
+
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// -------------------- pirâmide de resolução --------------------
+// Nível 0 é a imagem original; cada nível seguinte tem metade da largura e
+// da altura (média 2x2 dos valores crus, ainda antes do window/level).
+typedef std::vector<std::shared_ptr<const RawImage>> RawPyramid;
+
+// C amostras intercaladas por pixel; a soma de 4 amostras de 32 bits vai
+// para 64 bits.
+template<typename T, int C>
+static void Downsample2x2Kernel(const T* src, int sw, int sh, T* dst, int dw, int dh)
+{
+    typedef typename std::conditional<(sizeof(T) < 4), int32_t, int64_t>::type Acc;
+    const size_t srcRow = static_cast<size_t>(sw) * C;
+    const size_t dstRow = static_cast<size_t>(dw) * C;
+
+    for (int y = 0; y < dh; ++y) {
+        const int y0 = std::min(2*y,     sh - 1);
+        const int y1 = std::min(2*y + 1, sh - 1);
+        const T* r0 = src + static_cast<size_t>(y0) * srcRow;
+        const T* r1 = src + static_cast<size_t>(y1) * srcRow;
+        T* out = dst + static_cast<size_t>(y) * dstRow;
+
+        // colunas pares completas; a última pode repetir a borda
+        const int full = sw / 2;
+        for (int x = 0; x < full; ++x) {
+            for (int c = 0; c < C; ++c) {
+                const size_t a = static_cast<size_t>(2*x) * C + c;
+                const Acc s = Acc(r0[a]) + r0[a + C] + r1[a] + r1[a + C];
+                out[static_cast<size_t>(x) * C + c] = static_cast<T>((s + (s >= 0 ? 2 : -2)) / 4);
+            }
+        }
+        for (int x = full; x < dw; ++x) {
+            for (int c = 0; c < C; ++c) {
+                const size_t a = static_cast<size_t>(sw - 1) * C + c;
+                const Acc s = 2 * (Acc(r0[a]) + r1[a]);
+                out[static_cast<size_t>(x) * C + c] = static_cast<T>((s + (s >= 0 ? 2 : -2)) / 4);
+            }
+        }
+    }
+}
+
+// nullptr se o buffer do nível não puder ser alocado
+static std::shared_ptr<const RawImage> DownsampleRaw(const RawImage& src)
+{
+    auto dst = std::make_shared<RawImage>(src);   // formato, transformação e janela
+    dst->width = (src.width + 1) / 2;
+    dst->height = (src.height + 1) / 2;
+    dst->pixels = PixelBuffer::Allocate(dst->bytesPerLine() * static_cast<size_t>(dst->height));
+    if (dst->pixels.empty()) return nullptr;
+
+    DispatchSample(src.bitsAllocated, src.isSigned, [&](auto tag) {
+        typedef decltype(tag) T;
+        const T* s = reinterpret_cast<const T*>(src.pixels.data());
+        T* d = reinterpret_cast<T*>(dst->pixels.data());
+        if (src.isColor())
+            Downsample2x2Kernel<T, 3>(s, src.width, src.height, d, dst->width, dst->height);
+        else
+            Downsample2x2Kernel<T, 1>(s, src.width, src.height, d, dst->width, dst->height);
+    });
+    return dst;
+}
+
+// Gera níveis até o maior lado ficar <= minSide. Sem memória para um nível,
+// para ali: a pirâmide fica mais curta, mas o nível 0 continua valendo.
+static RawPyramid BuildRawPyramid(std::shared_ptr<const RawImage> base, int minSide = 256)
+{
+    RawPyramid levels;
+    if (!base || base->isNull()) return levels;
+    PERF_SCOPE("pyramid");
+
+    levels.push_back(std::move(base));
+    while (std::max(levels.back()->width, levels.back()->height) > minSide) {
+        std::shared_ptr<const RawImage> next = DownsampleRaw(*levels.back());
+        if (!next) break;
+        levels.push_back(std::move(next));
+    }
+    return levels;
+}
+
+#endif //READ_DICOM_GDCM_DICOM_PYRAMID_H
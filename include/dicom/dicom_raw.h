@@ -0,0 +1,348 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_RAW_H
+#define READ_DICOM_GDCM_DICOM_RAW_H
+#include <gdcmImageReader.h>
+#include <gdcmImage.h>
+#include <gdcmFile.h>
+#include <gdcmDataSet.h>
+#include <gdcmTag.h>
+#include <gdcmDataElement.h>
+#include <gdcmByteValue.h>
+#include <gdcmPixelFormat.h>
+#include <gdcmPhotometricInterpretation.h>
+
+#include <dicom/dicom_lut.h>
+#include <dicom/pixel_pool.h>
+#include <dicom/pixel_kernels.h>
+#include <dicom/dicom_stats.h>
+#include <dicom/perf_trace.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+// -------------------- helpers DICOM tags --------------------
+static bool TryGetDSString(const gdcm::DataSet& ds, uint16_t g, uint16_t e, std::string& out)
+{
+    gdcm::Tag tag(g, e);
+    if (!ds.FindDataElement(tag)) return false;
+
+    const gdcm::DataElement& de = ds.GetDataElement(tag);
+    const gdcm::ByteValue* bv = de.GetByteValue();
+    if (!bv) return false;
+
+    out.assign(bv->GetPointer(), bv->GetLength());
+    while (!out.empty() && (out.back() == '\0' || out.back() == ' ' || out.back() == '\r' || out.back() == '\n'))
+        out.pop_back();
+    return true;
+}
+
+static bool ParseDouble(const std::string& s, double& v)
+{
+    try {
+        size_t idx = 0;
+        v = std::stod(s, &idx);
+        return idx > 0;
+    } catch (...) { return false; }
+}
+
+// Window Center/Width (0028,1050)/(0028,1051); usa o primeiro valor quando há vários.
+static bool ReadWindowCenterWidth(const gdcm::DataSet& ds, double& wc, double& ww)
+{
+    std::string sWC, sWW;
+    if (!TryGetDSString(ds, 0x0028, 0x1050, sWC) || !TryGetDSString(ds, 0x0028, 0x1051, sWW))
+        return false;
+
+    auto first = [](std::string x){
+        auto p = x.find('\\');
+        if (p != std::string::npos) x = x.substr(0, p);
+        return x;
+    };
+    sWC = first(sWC);
+    sWW = first(sWW);
+
+    double tWC=0, tWW=0;
+    if (!(ParseDouble(sWC, tWC) && ParseDouble(sWW, tWW) && tWW > 1e-9))
+        return false;
+    wc = tWC; ww = tWW;
+    return true;
+}
+
+// Rescale Slope/Intercept (0028,1053)/(0028,1052); ausentes = identidade.
+static void ReadRescaleSlopeIntercept(const gdcm::DataSet& ds, double& slope, double& intercept)
+{
+    std::string s;
+    double v = 0.0;
+    slope = (TryGetDSString(ds, 0x0028, 0x1053, s) && ParseDouble(s, v) && v != 0.0) ? v : 1.0;
+    intercept = (TryGetDSString(ds, 0x0028, 0x1052, s) && ParseDouble(s, v)) ? v : 0.0;
+}
+
+// Pixel Padding Value (0028,0120) e Pixel Padding Range Limit (0028,0121),
+// binários (US ou SS conforme Pixel Representation). Sem o limite, a faixa
+// é só o valor. Devolve [lo, hi] em valores armazenados.
+static bool ReadPixelPadding(const gdcm::DataSet& ds, bool isSigned, double& lo, double& hi)
+{
+    auto read = [&](uint16_t e, double& v) {
+        const gdcm::Tag tag(0x0028, e);
+        if (!ds.FindDataElement(tag)) return false;
+        const gdcm::ByteValue* bv = ds.GetDataElement(tag).GetByteValue();
+        if (!bv || bv->GetLength() < 2) return false;
+        uint16_t u = 0;
+        std::memcpy(&u, bv->GetPointer(), 2);
+        v = isSigned ? static_cast<double>(static_cast<int16_t>(u)) : static_cast<double>(u);
+        return true;
+    };
+    double a = 0.0, b = 0.0;
+    if (!read(0x0120, a)) return false;
+    if (!read(0x0121, b)) b = a;
+    lo = std::min(a, b);
+    hi = std::max(a, b);
+    return true;
+}
+
+// -------------------- histograma sob demanda --------------------
+// Calculado na primeira vez que alguém pede (janela inicial sem tags de
+// janela, tecla "A"), sempre dos pixels do nível 0, e compartilhado pelos
+// níveis da pirâmide. O padding fica de fora. Depois do cálculo solta a
+// referência ao buffer. Pode ser pedido de qualquer thread.
+class LazyHistogram
+{
+public:
+    LazyHistogram(PixelBuffer pixels, size_t rows, size_t samplesPerRow, int bitsAllocated, bool isSigned)
+        : m_pixels(std::move(pixels)), m_rows(rows), m_samplesPerRow(samplesPerRow),
+          m_bits(bitsAllocated), m_signed(isSigned) {}
+
+    void excludeRange(double lo, double hi)
+    {
+        m_hasPadding = true;
+        m_padLow = lo;
+        m_padHigh = hi;
+    }
+
+    // threads só vale para quem calcular (0 = todos os núcleos)
+    const PixelHistogram& get(int threads = 0) const
+    {
+        std::call_once(m_once, [&]{
+            m_hist = ComputeHistogram(m_pixels.data(), m_rows, m_samplesPerRow, m_bits, m_signed, threads);
+            if (m_hasPadding) ExcludeFromHistogram(m_hist, m_padLow, m_padHigh);
+            m_pixels.reset();
+        });
+        return m_hist;
+    }
+
+private:
+    mutable std::once_flag   m_once;
+    mutable PixelBuffer      m_pixels;
+    mutable PixelHistogram   m_hist;
+    size_t m_rows;
+    size_t m_samplesPerRow;
+    int    m_bits;
+    bool   m_signed;
+    bool   m_hasPadding = false;
+    double m_padLow = 0.0;
+    double m_padHigh = 0.0;
+};
+
+// -------------------- pixels crus (antes do window/level) --------------------
+// Buffer decodificado pelo GDCM, linhas contíguas: 1 amostra por pixel
+// (MONOCHROME1/2) ou 3 intercaladas (RGB), de 8, 16 ou 32 bits com ou sem
+// sinal. Os valores ficam como armazenados (sem slope/intercept); a
+// transformação para valores de modalidade e a inversão de MONOCHROME1 são
+// aplicadas na LUT (transform()).
+// Os pixels vêm do PixelBufferPool; copiar um RawImage compartilha o buffer.
+// O histograma (LazyHistogram) é calculado uma vez, quando a primeira janela
+// automática precisa dele; as seguintes só percorrem os bins.
+struct RawImage
+{
+    int  width = 0;
+    int  height = 0;
+    int  bitsAllocated = 0;
+    int  samplesPerPixel = 1;
+    bool isSigned = false;
+
+    // Modality LUT linear e MONOCHROME1
+    double rescaleSlope = 1.0;
+    double rescaleIntercept = 0.0;
+    bool   invert = false;
+
+    // janela dos tags do arquivo, quando presente (valores de modalidade)
+    bool   hasWindow = false;
+    double windowCenter = 0.0;
+    double windowWidth = 0.0;
+
+    PixelBuffer pixels;
+    std::shared_ptr<const LazyHistogram> histogram;
+
+    bool isNull() const { return pixels.empty(); }
+    bool isColor() const { return samplesPerPixel == 3; }
+    size_t bytesPerSample() const { return static_cast<size_t>(bitsAllocated / 8); }
+    size_t bytesPerPixel() const { return bytesPerSample() * static_cast<size_t>(samplesPerPixel); }
+    size_t bytesPerLine() const { return static_cast<size_t>(width) * bytesPerPixel(); }
+    size_t pixelCount() const { return static_cast<size_t>(width) * static_cast<size_t>(height); }
+    size_t sampleCount() const { return pixelCount() * static_cast<size_t>(samplesPerPixel); }
+    const char* row(int y) const { return pixels.data() + static_cast<size_t>(y) * bytesPerLine(); }
+
+    SampleTransform transform() const { return { rescaleSlope, rescaleIntercept, invert }; }
+
+    bool buildLut(WindowLut& lut, const WindowRange& win) const
+    {
+        return lut.build(bitsAllocated, isSigned, win, transform());
+    }
+
+    // Janela por percentis do histograma (em valores de modalidade).
+    WindowRange autoWindow(double lowPct = kAutoWindowLowPct, double highPct = kAutoWindowHighPct) const
+    {
+        if (histogram && !histogram->get().empty())
+            return PercentileWindow(histogram->get(), lowPct, highPct, transform());
+        return minMaxWindow();
+    }
+
+    // Janela inicial: tags (0028,1050)/(0028,1051) ou percentis 0,5–99,5%
+    // dos pixels. RGB não tem VOI: faixa inteira do tipo.
+    WindowRange defaultWindow() const
+    {
+        if (hasWindow) return WindowFromCenterWidth(windowCenter, windowWidth);
+        if (isColor()) {
+            const double top = std::ldexp(1.0, bitsAllocated) - 1.0;
+            return { 0.0, top };
+        }
+        return autoWindow();
+    }
+
+    WindowRange minMaxWindow() const
+    {
+        if (histogram && !histogram->get().empty())
+            return PercentileWindow(histogram->get(), 0.0, 100.0, transform());
+        const WindowRange s = MinMaxWindow(pixels.data(), pixelCount(), bitsAllocated, isSigned);
+        const double a = rescaleSlope * s.low + rescaleIntercept;
+        const double b = rescaleSlope * s.high + rescaleIntercept;
+        return { std::min(a, b), std::max(a, b) };
+    }
+};
+
+// -------------------- remap para exibição (sem Qt) --------------------
+// Remapeia o retângulo [x0,x1) x [y0,y1) (já recortado aos limites da imagem)
+// para 8 bits por amostra: cinza 1 byte por pixel, RGB 3 (janela por canal).
+// dst aponta para o pixel de destino de (x0, y0). É o núcleo de
+// RawToDisplayRegion (dicom_lib.h), usado também pelo dicom_bench.
+static void RawToDisplayRows(const RawImage& raw, const WindowLut& lut, int x0, int y0, int x1, int y1,
+                             uint8_t* dst, size_t dstStride)
+{
+    const size_t bpp = raw.bytesPerPixel();
+    const size_t spp = static_cast<size_t>(raw.samplesPerPixel);
+    for (int y = y0; y < y1; ++y)
+        lut.apply(raw.row(y) + static_cast<size_t>(x0) * bpp,
+                  dst + static_cast<size_t>(y - y0) * dstStride,
+                  static_cast<size_t>(x1 - x0) * spp);
+}
+
+// ir.Read() medido como etapa "ir_read" (parse do arquivo; a descompressão
+// do GDCM só acontece depois, em GetBuffer, medida como "get_buffer").
+static bool ReadDicomImage(gdcm::ImageReader& ir)
+{
+    PERF_SCOPE("ir_read");
+    return ir.Read();
+}
+
+// Decodifica os pixels de um ImageReader já lido. O formato (bits, sinal,
+// amostras, fotometria, planar) é resolvido aqui, uma vez; o resto do
+// caminho só vê RawImage. Suporta MONOCHROME1/2 e RGB, 8/16/32 bits; outros
+// valores de Photometric Interpretation com uma amostra viram MONOCHROME2.
+// O histograma só é calculado aqui quando a janela inicial depende dele
+// (monocromática sem Window Center/Width); senão fica para o primeiro
+// autoWindow(). statsThreads: threads desse cálculo (0 = todos os núcleos;
+// loaders que já decodificam em paralelo passam 1; < 0 sempre deixa para
+// depois, para medir a decodificação separada das estatísticas).
+static bool DicomReadRawImage(const gdcm::ImageReader& ir, RawImage& raw, int statsThreads = 0)
+{
+    const gdcm::Image& img = ir.GetImage();
+    const gdcm::DataSet& ds = ir.GetFile().GetDataSet();
+
+    const unsigned int* dims = img.GetDimensions();
+    const gdcm::PixelFormat& pf = img.GetPixelFormat();
+    const gdcm::PhotometricInterpretation::PIType pi = img.GetPhotometricInterpretation();
+    const int bitsAllocated = pf.GetBitsAllocated();
+    const int spp = pf.GetSamplesPerPixel();
+
+    const bool mono = spp == 1;   // PI ausente/fora do padrão: MONOCHROME2
+    const bool rgb = spp == 3 && pi == gdcm::PhotometricInterpretation::RGB;
+    if (!mono && !rgb) return false;
+    if (!(bitsAllocated == 8 || bitsAllocated == 16 || bitsAllocated == 32)) return false;
+
+    raw.width = static_cast<int>(dims[0]);
+    raw.height = static_cast<int>(dims[1]);
+    raw.bitsAllocated = bitsAllocated;
+    raw.samplesPerPixel = spp;
+    raw.isSigned = pf.GetPixelRepresentation() == 1;
+    raw.invert = pi == gdcm::PhotometricInterpretation::MONOCHROME1;
+
+    // decodifica direto no buffer do pool (sem vector intermediário)
+    {
+        PERF_SCOPE_PIXELS("get_buffer", static_cast<uint64_t>(dims[0]) * static_cast<uint64_t>(dims[1]));
+        raw.pixels = PixelBuffer::Allocate(img.GetBufferLength());
+        if (raw.pixels.empty() || !img.GetBuffer(raw.pixels.data())) {
+            raw.pixels.reset();
+            return false;
+        }
+    }
+    // só o primeiro frame
+    const size_t frameBytes = raw.bytesPerLine() * static_cast<size_t>(raw.height);
+    if (raw.pixels.size() < frameBytes) {
+        raw.pixels.reset();
+        return false;
+    }
+    raw.pixels.truncate(frameBytes);
+
+    // uma escolha de tipo por imagem; os kernels rodam sem desvio por pixel
+    // cabeçalhos malformados: Bits Stored fora de 1..Bits Allocated vira
+    // Bits Allocated; High Bit fora de Bits Stored-1..Bits Allocated-1 vira
+    // Bits Stored-1 (o deslocamento do kernel fica sempre em 0..Bits Allocated-1)
+    int bitsStored = pf.GetBitsStored();
+    int highBit = pf.GetHighBit();
+    if (bitsStored <= 0 || bitsStored > bitsAllocated) bitsStored = bitsAllocated;
+    if (highBit < bitsStored - 1 || highBit >= bitsAllocated) highBit = bitsStored - 1;
+    const bool planar = rgb && img.GetPlanarConfiguration() == 1;
+    bool allocated = true;
+    DispatchSample(bitsAllocated, raw.isSigned, [&](auto tag) {
+        PERF_SCOPE("normalize");
+        typedef decltype(tag) T;
+        T* px = reinterpret_cast<T*>(raw.pixels.data());
+        const size_t n = raw.sampleCount();
+        if (bitsStored < bitsAllocated || highBit != bitsStored - 1)
+            StoredBitsKernel(px, n, bitsStored, highBit);
+        if (planar) {
+            PixelBuffer interleaved = PixelBuffer::Allocate(frameBytes);
+            if (interleaved.empty()) { allocated = false; return; }
+            PlanarToInterleavedKernel<T, 3>(px, reinterpret_cast<T*>(interleaved.data()), raw.pixelCount());
+            raw.pixels = std::move(interleaved);
+        }
+    });
+    if (!allocated) {
+        raw.pixels.reset();
+        return false;
+    }
+
+    if (mono) ReadRescaleSlopeIntercept(ds, raw.rescaleSlope, raw.rescaleIntercept);
+    raw.hasWindow = mono && ReadWindowCenterWidth(ds, raw.windowCenter, raw.windowWidth);
+
+    auto hist = std::make_shared<LazyHistogram>(raw.pixels, static_cast<size_t>(raw.height),
+                                                static_cast<size_t>(raw.width) * static_cast<size_t>(spp),
+                                                bitsAllocated, raw.isSigned);
+    double padLow = 0.0, padHigh = 0.0;
+    if (mono && bitsAllocated <= 16 && ReadPixelPadding(ds, raw.isSigned, padLow, padHigh))
+        hist->excludeRange(padLow, padHigh);
+    if (statsThreads >= 0 && mono && !raw.hasWindow) hist->get(statsThreads);
+    raw.histogram = std::move(hist);
+    return true;
+}
+
+#endif //READ_DICOM_GDCM_DICOM_RAW_H
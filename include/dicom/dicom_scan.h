@@ -0,0 +1,308 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_SCAN_H
+#define READ_DICOM_GDCM_DICOM_SCAN_H
+#include <gdcmReader.h>
+#include <gdcmTag.h>
+
+#include <dicom/dicom_raw.h>
+#include <dicom/perf_trace.h>
+#include <dicom/file_io.h>
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+
+// -------------------- leitura só do cabeçalho --------------------
+// Lê o arquivo até (7FE0,0010) sem carregar nem decodificar Pixel Data.
+static bool ReadDicomHeader(const std::string& path, gdcm::Reader& r)
+{
+    PERF_SCOPE("read_header");
+    r.SetFileName(path.c_str());
+    return r.ReadUpToTag(gdcm::Tag(0x7FE0, 0x0010), std::set<gdcm::Tag>());
+}
+
+// Tags lidas como texto (padding removido); vazio se ausente.
+static std::vector<std::string> ExtractStringTags(const gdcm::DataSet& ds, const std::vector<gdcm::Tag>& tags)
+{
+    std::vector<std::string> values(tags.size());
+    for (size_t i = 0; i < tags.size(); ++i)
+        TryGetDSString(ds, tags[i].GetGroup(), tags[i].GetElement(), values[i]);
+    return values;
+}
+
+// -------------------- índice persistente --------------------
+struct ScanRecord
+{
+    std::string path;
+    int64_t     mtime = 0;
+    uint64_t    size = 0;
+    std::vector<std::string> values;   // na ordem de DicomIndex::tags()
+};
+
+struct ScanStats
+{
+    size_t files = 0;       // arquivos encontrados
+    size_t scanned = 0;     // cabeçalhos lidos nesta execução
+    size_t reused = 0;      // vindos do índice (mtime/tamanho iguais)
+    size_t failed = 0;      // não são DICOM ou ilegíveis (lidos nesta execução)
+    size_t skipped = 0;     // já rejeitados antes, com mtime/tamanho iguais (não relidos)
+};
+
+// Formato binário compacto (little endian nativo):
+//   "DCMIDX2\n" | u32 nTags | u32 tag... | u64 nRecords |
+//   por registro: str path | i64 mtime | u64 size | str valor * nTags
+//   u64 nRejected | por rejeitado: str path | i64 mtime | u64 size
+//   str = u32 len + bytes
+// Os rejeitados (não DICOM: DICOMDIR, laudos, .txt...) ficam no índice para
+// não passarem de novo pelo GDCM enquanto não mudarem.
+class DicomIndex
+{
+public:
+    explicit DicomIndex(std::vector<gdcm::Tag> tags) : m_tags(std::move(tags)) {}
+
+    const std::vector<gdcm::Tag>& tags() const { return m_tags; }
+    const std::vector<ScanRecord>& records() const { return m_records; }
+
+    // Índice ausente, corrompido, truncado ou com outra lista de tags: começa
+    // vazio (a próxima varredura relê tudo).
+    bool load(const std::string& file)
+    {
+        m_records.clear();
+        m_rejected.clear();
+        std::ifstream in(file, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        const std::streamoff fileSize = in.tellg();
+        in.seekg(0);
+
+        char magic[8];
+        if (!in.read(magic, 8) || std::string(magic, 8) != std::string(kMagic, 8)) return false;
+
+        uint32_t nTags = 0;
+        if (!GetBinary(in, nTags) || nTags != m_tags.size()) return false;
+        for (const auto& t : m_tags) {
+            uint32_t v = 0;
+            if (!GetBinary(in, v) || v != TagKey(t)) return false;
+        }
+
+        // contagens vêm do arquivo: limitadas pelo que ainda cabe nele antes
+        // de qualquer reserva, e os registros são lidos um a um
+        std::vector<ScanRecord> recs, rejected;
+        const uint64_t minRecord = 4 + 8 + 8 + 4 * static_cast<uint64_t>(m_tags.size());
+        if (!readRecords(in, fileSize, minRecord, m_tags.size(), recs)) return false;
+        if (!readRecords(in, fileSize, 4 + 8 + 8, 0, rejected)) return false;
+        m_records = std::move(recs);
+        m_rejected = std::move(rejected);
+        return true;
+    }
+
+    bool save(const std::string& file) const
+    {
+        // grava num temporário e renomeia: um índice truncado nunca substitui o anterior
+        const std::string tmp = file + ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(kMagic, 8);
+        PutBinary(out, static_cast<uint32_t>(m_tags.size()));
+        for (const auto& t : m_tags) PutBinary(out, TagKey(t));
+        PutBinary(out, static_cast<uint64_t>(m_records.size()));
+        for (const auto& r : m_records) {
+            PutBinaryString(out, r.path);
+            PutBinary(out, r.mtime);
+            PutBinary(out, r.size);
+            for (const auto& v : r.values) PutBinaryString(out, v);
+        }
+        PutBinary(out, static_cast<uint64_t>(m_rejected.size()));
+        for (const auto& r : m_rejected) {
+            PutBinaryString(out, r.path);
+            PutBinary(out, r.mtime);
+            PutBinary(out, r.size);
+        }
+        // close() faz o último flush: o estado só vale depois dele
+        out.close();
+        if (!out) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, file, ec);
+        if (ec) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Percorre as pastas, reaproveita registros (e rejeições) com mtime/tamanho
+    // iguais e lê em paralelo só os cabeçalhos novos ou alterados. Caminhos
+    // são canônicos: pastas sobrepostas e links não indexam um arquivo duas
+    // vezes. Registros de fora das pastas desta execução continuam no índice;
+    // os de dentro que sumiram do disco saem. prune: o índice fica só com o
+    // que foi encontrado agora.
+    ScanStats update(const std::vector<std::string>& roots, int threads, bool prune = false)
+    {
+        namespace fs = std::filesystem;
+        ScanStats st;
+
+        std::unordered_map<std::string, const ScanRecord*> old;
+        for (const auto& r : m_records) old.emplace(r.path, &r);
+        std::unordered_map<std::string, const ScanRecord*> oldRejected;
+        for (const auto& r : m_rejected) oldRejected.emplace(r.path, &r);
+
+        std::vector<ScanRecord> next, rejected;
+        std::vector<size_t> todo;   // índices em next que precisam de leitura
+        std::unordered_set<std::string> seen;
+        std::vector<fs::path> scannedRoots;
+        std::error_code ec;
+        auto visit = [&](const fs::path& p) {
+            const FileStamp fst = StatFile(p);
+            if (!fst.valid || !seen.insert(p.string()).second) return;
+
+            ScanRecord rec;
+            rec.path = p.string();
+            rec.size = fst.size;
+            rec.mtime = fst.mtime;
+
+            auto same = [&](const std::unordered_map<std::string, const ScanRecord*>& m) {
+                auto it = m.find(rec.path);
+                return it != m.end() && it->second->mtime == rec.mtime && it->second->size == rec.size
+                       ? it->second : nullptr;
+            };
+            if (const ScanRecord* r = same(old)) {
+                next.push_back(*r);
+                ++st.reused;
+            } else if (same(oldRejected)) {
+                rejected.push_back(std::move(rec));
+                ++st.skipped;
+            } else {
+                todo.push_back(next.size());
+                next.push_back(std::move(rec));
+            }
+        };
+        for (const auto& root : roots) {
+            const fs::path croot = fs::canonical(root, ec);
+            if (ec) continue;
+            if (fs::is_directory(croot, ec)) {
+                scannedRoots.push_back(croot);
+                // sem seguir links de pasta, só os de arquivo precisam ser resolvidos
+                for (const auto& de : fs::recursive_directory_iterator(croot, fs::directory_options::skip_permission_denied, ec)) {
+                    std::error_code fec;
+                    if (!de.is_regular_file(fec)) continue;
+                    if (de.is_symlink(fec)) {
+                        const fs::path target = fs::canonical(de.path(), fec);
+                        if (!fec) visit(target);
+                    } else {
+                        visit(de.path());
+                    }
+                }
+            } else if (fs::is_regular_file(croot, ec)) {
+                scannedRoots.push_back(croot);
+                visit(croot);
+            }
+        }
+
+        std::vector<char> ok(todo.size(), 0);
+        std::atomic<size_t> cursor{0};
+        auto worker = [&]{
+            for (size_t k; (k = cursor.fetch_add(1)) < todo.size(); ) {
+                ScanRecord& rec = next[todo[k]];
+                gdcm::Reader r;
+                if (!ReadDicomHeader(rec.path, r)) continue;
+                rec.values = ExtractStringTags(r.GetFile().GetDataSet(), m_tags);
+                ok[k] = 1;
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int i = 1; i < std::max(1, threads); ++i) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+
+        // o que não é DICOM vai para os rejeitados
+        std::vector<char> keep(next.size(), 1);
+        for (size_t k = 0; k < todo.size(); ++k) {
+            if (ok[k]) ++st.scanned;
+            else { keep[todo[k]] = 0; ++st.failed; }
+        }
+        st.files = next.size() + rejected.size();
+
+        // registros antigos não vistos agora: ficam se estão fora das pastas
+        // varridas (sem prune); dentro delas, o arquivo foi removido
+        auto carryOver = [&](std::vector<ScanRecord>& from, std::vector<ScanRecord>& to) {
+            if (prune) return;
+            for (auto& r : from)
+                if (!seen.count(r.path) && !UnderAny(r.path, scannedRoots)) to.push_back(std::move(r));
+        };
+
+        std::vector<ScanRecord> records;
+        for (size_t i = 0; i < next.size(); ++i) {
+            if (keep[i]) {
+                records.push_back(std::move(next[i]));
+            } else {
+                next[i].values.clear();
+                rejected.push_back(std::move(next[i]));
+            }
+        }
+        carryOver(m_records, records);
+        carryOver(m_rejected, rejected);
+        m_records = std::move(records);
+        m_rejected = std::move(rejected);
+        return st;
+    }
+
+    static uint32_t TagKey(const gdcm::Tag& t)
+    {
+        return (static_cast<uint32_t>(t.GetGroup()) << 16) | t.GetElement();
+    }
+
+private:
+    static constexpr const char* kMagic = "DCMIDX2\n";
+
+    // path (canônico) igual a uma das raízes ou dentro dela
+    static bool UnderAny(const std::string& path, const std::vector<std::filesystem::path>& roots)
+    {
+        const std::filesystem::path p(path);
+        for (const auto& root : roots) {
+            auto r = root.begin(), q = p.begin();
+            for (; r != root.end() && q != p.end() && *r == *q; ++r, ++q) {}
+            // "/dados/" termina num componente vazio
+            if (r == root.end() || (r->empty() && std::next(r) == root.end())) return true;
+        }
+        return false;
+    }
+
+    static bool readRecords(std::istream& in, std::streamoff fileSize, uint64_t minRecord,
+                            size_t nValues, std::vector<ScanRecord>& out)
+    {
+        uint64_t n = 0;
+        if (!GetBinary(in, n)) return false;
+        const std::streamoff pos = in.tellg();
+        if (pos < 0 || n > static_cast<uint64_t>(fileSize - pos) / minRecord) return false;
+        for (uint64_t i = 0; i < n; ++i) {
+            ScanRecord r;
+            r.values.resize(nValues);
+            if (!GetBinaryString(in, r.path) || !GetBinary(in, r.mtime) || !GetBinary(in, r.size)) return false;
+            for (auto& v : r.values)
+                if (!GetBinaryString(in, v)) return false;
+            out.push_back(std::move(r));
+        }
+        return true;
+    }
+
+    std::vector<gdcm::Tag>  m_tags;
+    std::vector<ScanRecord> m_records;
+    std::vector<ScanRecord> m_rejected;   // só path/mtime/size
+};
+
+#endif //READ_DICOM_GDCM_DICOM_SCAN_H
@@ -0,0 +1,412 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_SERIES_H
+#define READ_DICOM_GDCM_DICOM_SERIES_H
+#include <gdcmImageReader.h>
+#include <gdcmReader.h>
+
+#include <dicom/dicom_raw.h>
+#include <dicom/dicom_pyramid.h>
+#include <dicom/dicom_scan.h>
+#include <dicom/dicom_tag_schema.h>
+#include <dicom/dicom_cache.h>
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <filesystem>
+#include <algorithm>
+#include <optional>
+#include <cstdint>
+#include <cstdlib>
+
+// -------------------- série: descoberta e ordenação --------------------
+struct SeriesSlice
+{
+    std::string path;
+    std::string seriesUid;
+    int    instanceNumber = 0;
+    double position[3] = { 0.0, 0.0, 0.0 };
+    double normal[3] = { 0.0, 0.0, 0.0 };
+    bool   hasGeometry = false;
+};
+
+struct SliceTags
+{
+    std::string_view seriesUid;
+    std::optional<int> instanceNumber;
+    std::string_view position;      // (0020,0032) DS\DS\DS
+    std::string_view orientation;   // (0020,0037) DS*6
+};
+
+typedef TagSchema<
+    TagField<0x0020, 0x000E, gdcm::VR::UI, &SliceTags::seriesUid>,
+    TagField<0x0020, 0x0013, gdcm::VR::IS, &SliceTags::instanceNumber>,
+    TagField<0x0020, 0x0032, gdcm::VR::DS, &SliceTags::position>,
+    TagField<0x0020, 0x0037, gdcm::VR::DS, &SliceTags::orientation>
+> SliceTagSchema;
+
+// lê n valores de um DS multivalorado ("a\b\c")
+static bool ParseDSValues(std::string_view s, double* out, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        const size_t sep = s.find('\\');
+        if (!tag_schema_detail::ParseNumber(tag_schema_detail::FirstValue(s.substr(0, sep)), out[i]))
+            return false;
+        if (sep == std::string_view::npos) return i == n - 1;
+        s.remove_prefix(sep + 1);
+    }
+    return true;
+}
+
+// Lê os cabeçalhos da pasta em paralelo, fica com a série mais numerosa e
+// ordena por posição ao longo da normal do plano (ou por Instance Number).
+static std::vector<SeriesSlice> ScanSeriesDirectory(const std::string& dir, int threads)
+{
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(dir, fs::directory_options::skip_permission_denied, ec))
+        if (de.is_regular_file(ec)) files.push_back(de.path().string());
+
+    std::vector<SeriesSlice> slices(files.size());
+    std::vector<char> ok(files.size(), 0);
+    std::atomic<size_t> cursor{0};
+    auto worker = [&]{
+        for (size_t k; (k = cursor.fetch_add(1)) < files.size(); ) {
+            gdcm::Reader r;
+            if (!ReadDicomHeader(files[k], r)) continue;
+
+            SliceTags t;
+            SliceTagSchema::Extract(r.GetFile().GetDataSet(), t);
+
+            SeriesSlice& s = slices[k];
+            s.path = files[k];
+            s.seriesUid.assign(t.seriesUid.data(), t.seriesUid.size());
+            s.instanceNumber = t.instanceNumber.value_or(0);
+            double o[6];
+            if (ParseDSValues(t.position, s.position, 3) && ParseDSValues(t.orientation, o, 6)) {
+                s.normal[0] = o[1]*o[5] - o[2]*o[4];
+                s.normal[1] = o[2]*o[3] - o[0]*o[5];
+                s.normal[2] = o[0]*o[4] - o[1]*o[3];
+                s.hasGeometry = true;
+            }
+            ok[k] = 1;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < std::max(1, threads); ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+
+    // série com mais arquivos
+    std::map<std::string, size_t> count;
+    for (size_t k = 0; k < slices.size(); ++k)
+        if (ok[k]) ++count[slices[k].seriesUid];
+    if (count.empty()) return {};
+    const std::string uid = std::max_element(count.begin(), count.end(),
+        [](const auto& a, const auto& b){ return a.second < b.second; })->first;
+
+    std::vector<SeriesSlice> series;
+    for (size_t k = 0; k < slices.size(); ++k)
+        if (ok[k] && slices[k].seriesUid == uid) series.push_back(std::move(slices[k]));
+
+    const bool geometry = std::all_of(series.begin(), series.end(),
+                                      [](const SeriesSlice& s){ return s.hasGeometry; });
+    auto along = [](const SeriesSlice& s) {
+        return s.position[0]*s.normal[0] + s.position[1]*s.normal[1] + s.position[2]*s.normal[2];
+    };
+    std::stable_sort(series.begin(), series.end(), [&](const SeriesSlice& a, const SeriesSlice& b) {
+        if (geometry && along(a) != along(b)) return along(a) < along(b);
+        if (a.instanceNumber != b.instanceNumber) return a.instanceNumber < b.instanceNumber;
+        return a.path < b.path;
+    });
+    return series;
+}
+
+// -------------------- carregamento com prefetch --------------------
+// Decodifica fatias num pool de threads. request(i, dir) só registra a fatia
+// atual e o sentido da rolagem; cada worker pega sempre a fatia pendente
+// mais prioritária: a atual, depois até `prefetch` à frente no sentido da
+// rolagem, depois algumas atrás. Mudar de sentido reprioriza na hora.
+// A janela de prefetch encolhe para caber em maxBytes (pelo tamanho da última
+// fatia decodificada); acima de maxBytes, descarta as fatias de menor
+// prioridade, na mesma ordem da janela, para não descartar e redecodificar
+// em ciclo a mesma fatia.
+// Com um FrameCache, fatias descartadas ou de uma reabertura saem da memória
+// sem redecodificar; com um ThumbnailStore, cada fatia decodificada ganha uma
+// miniatura em disco, usada como pré-visualização (preview) da próxima vez.
+// As miniaturas são lidas do disco pelos workers (antes de decodificar a
+// fatia e, sem decodificação pendente, as próximas da atual) e ficam num mapa
+// em memória: preview() na thread da GUI é só uma consulta.
+class SeriesLoader
+{
+public:
+    // chamado na thread do worker quando há algo novo da fatia: pré-visualização
+    // ou pirâmide prontas (ok = true; get() pode ainda estar vazio) ou falha
+    typedef std::function<void(int index, bool ok)> ReadyCallback;
+
+    SeriesLoader(std::vector<SeriesSlice> slices, int threads, int prefetch = 8,
+                 size_t maxBytes = size_t(1) << 30,
+                 FrameCache* cache = nullptr, const ThumbnailStore* thumbs = nullptr)
+        : m_slices(std::move(slices)), m_prefetch(prefetch), m_maxBytes(maxBytes),
+          m_cache(cache), m_thumbs(thumbs)
+    {
+        for (int i = 0; i < std::max(1, threads); ++i)
+            m_workers.emplace_back([this]{ workerLoop(); });
+    }
+
+    ~SeriesLoader()
+    {
+        shutdown();
+        for (auto& t : m_workers) t.join();
+    }
+
+    // Não bloqueia (só espera um callback já em andamento terminar): nenhum
+    // callback é chamado depois do retorno e os workers saem ao terminar a
+    // fatia em andamento (uma decodificação do GDCM não é interrompível).
+    // Quem não pode esperar por ela destrói o loader em outra thread.
+    // Não chamar de dentro de um callback.
+    void shutdown()
+    {
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_stop = true;
+            m_ready = nullptr;
+            m_idle.wait(lk, [&]{ return m_notifying == 0; });
+        }
+        m_wake.notify_all();
+    }
+
+    int size() const { return static_cast<int>(m_slices.size()); }
+    const SeriesSlice& slice(int i) const { return m_slices[static_cast<size_t>(i)]; }
+
+    void setReadyCallback(ReadyCallback cb)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_ready = std::move(cb);
+    }
+
+    // não bloqueia
+    void request(int index, int direction)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_current = std::max(0, std::min(size() - 1, index));
+            m_direction = direction < 0 ? -1 : 1;
+        }
+        m_wake.notify_all();
+    }
+
+    // pirâmide da fatia, ou vazio se ainda não foi decodificada
+    RawPyramid get(int index) const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_loaded.find(index);
+        return it != m_loaded.end() ? it->second.levels : RawPyramid();
+    }
+
+    // miniatura da fatia já carregada pelos workers (vazia se ainda não há)
+    Thumbnail preview(int index) const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_previews.find(index);
+        return it != m_previews.end() ? it->second : Thumbnail();
+    }
+
+private:
+    struct Entry
+    {
+        RawPyramid levels;
+        size_t     bytes = 0;
+    };
+
+    // fatias à frente/atrás que cabem no orçamento junto com a atual
+    void prefetchWindow(int& ahead, int& behind) const
+    {
+        ahead = m_prefetch;
+        behind = std::max(1, m_prefetch / 4);
+        if (m_sliceBytes == 0) return;
+        const size_t fit = std::max<size_t>(1, m_maxBytes / m_sliceBytes);
+        const int extra = static_cast<int>(std::min<size_t>(fit - 1, static_cast<size_t>(ahead + behind)));
+        ahead = std::min(ahead, extra);
+        behind = std::min(behind, extra - ahead);
+    }
+
+    // 0 = atual; depois a janela à frente, a janela atrás e o resto por distância
+    int priority(int i) const
+    {
+        int ahead, behind;
+        prefetchWindow(ahead, behind);
+        const int d = (i - m_current) * m_direction;
+        if (d >= 0 && d <= ahead) return d;
+        if (d < 0 && -d <= behind) return ahead - d;
+        return ahead + behind + std::abs(d);
+    }
+
+    // ordem de prioridade a partir da fatia atual (com m_mutex travado)
+    int pickNext() const
+    {
+        if (m_current < 0) return -1;
+        auto pending = [&](int i) {
+            return i >= 0 && i < size() && !m_loaded.count(i) && !m_inFlight.count(i) && !m_failed.count(i);
+        };
+        int ahead, behind;
+        prefetchWindow(ahead, behind);
+        if (pending(m_current)) return m_current;
+        for (int k = 1; k <= ahead; ++k)
+            if (pending(m_current + k * m_direction)) return m_current + k * m_direction;
+        for (int k = 1; k <= behind; ++k)
+            if (pending(m_current - k * m_direction)) return m_current - k * m_direction;
+        return -1;
+    }
+
+    // próxima miniatura a ler do disco: a mais perto da atual, no sentido da
+    // rolagem primeiro, até kPreviewRadius (com m_mutex travado)
+    int pickPreview() const
+    {
+        if (!m_thumbs || m_current < 0) return -1;
+        auto pending = [&](int i) {
+            return i >= 0 && i < size() && !m_previewTried.count(i) && !m_loaded.count(i);
+        };
+        for (int k = 0; k <= kPreviewRadius; ++k) {
+            if (pending(m_current + k * m_direction)) return m_current + k * m_direction;
+            if (pending(m_current - k * m_direction)) return m_current - k * m_direction;
+        }
+        return -1;
+    }
+
+    // guarda a miniatura e esquece as muito longe da atual (com m_mutex travado)
+    void putPreview(int index, const Thumbnail& t)
+    {
+        m_previews[index] = t;
+        for (auto it = m_previewTried.begin(); it != m_previewTried.end(); ) {
+            if (std::abs(*it - m_current) > 2 * kPreviewRadius) {
+                m_previews.erase(*it);
+                it = m_previewTried.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // lê a miniatura em disco de index, se ainda não foi tentada (destrava m_mutex)
+    bool loadPreview(std::unique_lock<std::mutex>& lk, int index)
+    {
+        if (!m_thumbs || !m_previewTried.insert(index).second) return false;
+        const std::string path = m_slices[static_cast<size_t>(index)].path;
+        lk.unlock();
+        const Thumbnail t = m_thumbs->load(path, StatFile(path));
+        lk.lock();
+        if (!t) return false;
+        putPreview(index, t);
+        return true;
+    }
+
+    void notify(std::unique_lock<std::mutex>& lk, int index, bool ok)
+    {
+        if (!m_ready) return;
+        ReadyCallback cb = m_ready;
+        ++m_notifying;
+        lk.unlock();
+        cb(index, ok);
+        lk.lock();
+        if (--m_notifying == 0) m_idle.notify_all();
+    }
+
+    void evict()
+    {
+        while (m_bytes > m_maxBytes && m_loaded.size() > 1) {
+            auto worst = std::max_element(m_loaded.begin(), m_loaded.end(),
+                [&](const auto& a, const auto& b){ return priority(a.first) < priority(b.first); });
+            if (worst->first == m_current) break;
+            m_bytes -= worst->second.bytes;
+            m_loaded.erase(worst);
+        }
+    }
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        for (;;) {
+            int index = -1, previewIndex = -1;
+            m_wake.wait(lk, [&]{
+                return m_stop || (index = pickNext()) >= 0 || (previewIndex = pickPreview()) >= 0;
+            });
+            if (m_stop) return;
+
+            // sem decodificação pendente: adianta miniaturas das próximas fatias
+            if (index < 0) {
+                if (loadPreview(lk, previewIndex)) notify(lk, previewIndex, true);
+                continue;
+            }
+
+            m_inFlight.insert(index);
+            if (loadPreview(lk, index)) notify(lk, index, true);
+            const bool hasPreview = m_previews.count(index) != 0;
+            const std::string path = m_slices[static_cast<size_t>(index)].path;
+            lk.unlock();
+
+            Entry e;
+            e.levels = LoadRawPyramidCached(m_cache, path, 1);
+            const bool ok = !e.levels.empty();
+            for (const auto& l : e.levels) e.bytes += l->pixels.size();
+            Thumbnail rendered;
+            if (ok && m_thumbs && !hasPreview) {
+                rendered = m_thumbs->render(e.levels, e.levels.back()->defaultWindow());
+                m_thumbs->save(path, StatFile(path), rendered);
+            }
+
+            lk.lock();
+            m_inFlight.erase(index);
+            if (rendered) putPreview(index, rendered);
+            if (ok) {
+                m_sliceBytes = e.bytes;
+                m_bytes += e.bytes;
+                m_loaded[index] = std::move(e);
+                evict();
+            } else {
+                m_failed.insert(index);
+            }
+            notify(lk, index, ok);
+        }
+    }
+
+    static constexpr int kPreviewRadius = 64;
+
+    const std::vector<SeriesSlice> m_slices;
+    const int    m_prefetch;
+    const size_t m_maxBytes;
+    FrameCache*  const m_cache;
+    const ThumbnailStore* const m_thumbs;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;     // m_notifying voltou a 0
+    int    m_notifying = 0;             // callbacks em andamento (fora do lock)
+    std::unordered_map<int, Entry> m_loaded;
+    std::unordered_set<int> m_inFlight;
+    std::unordered_set<int> m_failed;
+    std::unordered_map<int, Thumbnail> m_previews;
+    std::unordered_set<int> m_previewTried;     // lidas ou tentadas (sem miniatura em disco)
+    size_t m_bytes = 0;
+    size_t m_sliceBytes = 0;    // última fatia decodificada (fatias de uma série têm o mesmo tamanho)
+    int    m_current = -1;
+    int    m_direction = 1;
+    bool   m_stop = false;
+    ReadyCallback m_ready;
+
+    std::vector<std::thread> m_workers;
+};
+
+#endif //READ_DICOM_GDCM_DICOM_SERIES_H
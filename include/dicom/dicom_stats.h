@@ -0,0 +1,240 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_STATS_H
+#define READ_DICOM_GDCM_DICOM_STATS_H
+
+#include <dicom/dicom_lut.h>
+#include <dicom/pixel_kernels.h>
+#include <dicom/perf_trace.h>
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+// -------------------- histograma dos valores armazenados --------------------
+// 8/16 bits: um bin por valor possível (256 / 65536), em ordem de valor
+// (bin 0 = menor valor do tipo), então min/max saem do próprio histograma.
+// 32 bits: 65536 bins uniformes entre min e max.
+struct PixelHistogram
+{
+    std::vector<uint64_t> bins;
+    uint64_t total = 0;
+    double   minValue = 0.0;    // valores armazenados (sem slope/intercept)
+    double   maxValue = 0.0;
+    double   binLow = 0.0;      // valor do início do bin 0
+    double   binWidth = 1.0;
+
+    bool empty() const { return total == 0; }
+    double binValue(size_t i) const { return binLow + static_cast<double>(i) * binWidth; }
+
+    // Valor armazenado abaixo do qual fica a fração p (0..1) das amostras.
+    double percentile(double p) const
+    {
+        if (empty()) return 0.0;
+        const double target = std::max(0.0, std::min(1.0, p)) * static_cast<double>(total);
+        uint64_t acc = 0;
+        for (size_t i = 0; i < bins.size(); ++i) {
+            acc += bins[i];
+            if (static_cast<double>(acc) >= target && acc > 0)
+                return std::max(minValue, std::min(maxValue, binValue(i)));
+        }
+        return maxValue;
+    }
+};
+
+// -------------------- kernels por faixa de linhas --------------------
+// Índice do bin em ordem de valor: com sinal, inverte o bit mais alto.
+template<typename T>
+static inline size_t ValueBin(T v)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    if constexpr (std::is_signed<T>::value)
+        return static_cast<size_t>(static_cast<U>(static_cast<U>(v) ^ (U(1) << (sizeof(T) * 8 - 1))));
+    else
+        return static_cast<size_t>(v);
+}
+
+// 8/16 bits. Quatro sub-histogramas intercalados (8 bits) evitam que
+// incrementos seguidos no mesmo bin esperem um pelo outro; em 16 bits o
+// histograma já é grande demais para isso valer a pena.
+template<typename T>
+static void HistogramKernel(const T* __restrict px, size_t n, uint32_t* __restrict hist)
+{
+    if constexpr (sizeof(T) == 1) {
+        uint32_t* h0 = hist;
+        uint32_t* h1 = hist + 256;
+        uint32_t* h2 = hist + 512;
+        uint32_t* h3 = hist + 768;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            ++h0[ValueBin(px[i+0])];
+            ++h1[ValueBin(px[i+1])];
+            ++h2[ValueBin(px[i+2])];
+            ++h3[ValueBin(px[i+3])];
+        }
+        for (; i < n; ++i) ++h0[ValueBin(px[i])];
+    } else {
+        for (size_t i = 0; i < n; ++i) ++hist[ValueBin(px[i])];
+    }
+}
+
+// 32 bits: bins uniformes entre lo e lo + (bins-1)/scale.
+template<typename T>
+static void HistogramRangeKernel(const T* __restrict px, size_t n, uint32_t* __restrict hist,
+                                 double lo, double scale, size_t bins)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const size_t b = static_cast<size_t>((static_cast<double>(px[i]) - lo) * scale);
+        ++hist[std::min(b, bins - 1)];
+    }
+}
+
+// -------------------- passagem paralela --------------------
+// Divide o buffer em faixas de linhas de ~256 KiB (cabem no L2) que as
+// threads pegam por um cursor atômico; cada thread acumula no seu próprio
+// histograma e no fim eles são somados.
+template<typename F>
+static void ForEachRowBand(const char* data, size_t rows, size_t rowBytes, int threads, F&& f)
+{
+    const size_t bandRows = std::max<size_t>(1, (size_t(256) << 10) / std::max<size_t>(1, rowBytes));
+    const size_t bands = (rows + bandRows - 1) / bandRows;
+    std::atomic<size_t> cursor{0};
+
+    auto worker = [&](int t) {
+        for (size_t b; (b = cursor.fetch_add(1)) < bands; ) {
+            const size_t r0 = b * bandRows;
+            const size_t r1 = std::min(rows, r0 + bandRows);
+            f(t, data + r0 * rowBytes, (r1 - r0) * rowBytes);
+        }
+    };
+    const int n = static_cast<int>(std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::max(1, threads)), bands)));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool) th.join();
+}
+
+static int StatsThreads(int threads)
+{
+    if (threads > 0) return threads;
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// total e min/max a partir dos bins
+static void UpdateHistogramTotals(PixelHistogram& h)
+{
+    h.total = 0;
+    for (uint64_t c : h.bins) h.total += c;
+    if (h.total == 0) return;
+    size_t first = 0, last = h.bins.size() - 1;
+    while (h.bins[first] == 0) ++first;
+    while (h.bins[last] == 0) --last;
+    h.minValue = h.binValue(first);
+    h.maxValue = h.binValue(last);
+}
+
+// Histograma (e min/max) de todas as amostras, numa passagem para 8/16 bits
+// e duas para 32 bits (min/max define a faixa dos bins).
+static PixelHistogram ComputeHistogram(const void* pixels, size_t rows, size_t samplesPerRow,
+                                       int bitsAllocated, bool isSigned, int threads = 0)
+{
+    PixelHistogram h;
+    const size_t bps = static_cast<size_t>(bitsAllocated / 8);
+    const size_t rowBytes = samplesPerRow * bps;
+    if (!pixels || rows == 0 || samplesPerRow == 0) return h;
+    PERF_SCOPE("histogram");
+    const int nt = StatsThreads(threads);
+    const char* data = static_cast<const char*>(pixels);
+
+    DispatchSample(bitsAllocated, isSigned, [&](auto tag) {
+        typedef decltype(tag) T;
+        const size_t bins = sizeof(T) == 4 ? size_t(65536) : size_t(1) << (8 * sizeof(T));
+        const size_t local = sizeof(T) == 1 ? 4 * bins : bins;
+        std::vector<std::vector<uint32_t>> parts(static_cast<size_t>(nt));
+
+        if constexpr (sizeof(T) < 4) {
+            ForEachRowBand(data, rows, rowBytes, nt, [&](int t, const char* p, size_t bytes) {
+                auto& hist = parts[static_cast<size_t>(t)];
+                if (hist.empty()) hist.assign(local, 0);
+                HistogramKernel(reinterpret_cast<const T*>(p), bytes / sizeof(T), hist.data());
+            });
+            h.binLow = static_cast<double>(std::numeric_limits<T>::min());
+            h.binWidth = 1.0;
+        } else {
+            // 1ª passagem: min/max (vetorizável)
+            std::vector<T> mins(static_cast<size_t>(nt), std::numeric_limits<T>::max());
+            std::vector<T> maxs(static_cast<size_t>(nt), std::numeric_limits<T>::min());
+            ForEachRowBand(data, rows, rowBytes, nt, [&](int t, const char* p, size_t bytes) {
+                T mn, mx;
+                MinMaxKernel(reinterpret_cast<const T*>(p), bytes / sizeof(T), mn, mx);
+                mins[static_cast<size_t>(t)] = std::min(mins[static_cast<size_t>(t)], mn);
+                maxs[static_cast<size_t>(t)] = std::max(maxs[static_cast<size_t>(t)], mx);
+            });
+            const double lo = static_cast<double>(*std::min_element(mins.begin(), mins.end()));
+            const double hi = static_cast<double>(*std::max_element(maxs.begin(), maxs.end()));
+            const double scale = hi > lo ? static_cast<double>(bins - 1) / (hi - lo) : 0.0;
+
+            // 2ª passagem: bins uniformes
+            ForEachRowBand(data, rows, rowBytes, nt, [&](int t, const char* p, size_t bytes) {
+                auto& hist = parts[static_cast<size_t>(t)];
+                if (hist.empty()) hist.assign(local, 0);
+                HistogramRangeKernel(reinterpret_cast<const T*>(p), bytes / sizeof(T), hist.data(),
+                                     lo, scale, bins);
+            });
+            h.binLow = lo;
+            h.binWidth = scale > 0.0 ? 1.0 / scale : 1.0;
+        }
+
+        // soma das threads (e dos sub-histogramas de 8 bits)
+        h.bins.assign(bins, 0);
+        for (const auto& part : parts)
+            for (size_t i = 0; i < part.size(); ++i)
+                h.bins[i % bins] += part[i];
+    });
+
+    UpdateHistogramTotals(h);
+    return h;
+}
+
+// Tira do histograma os valores armazenados em [lo, hi] (Pixel Padding
+// Value / Range Limit): o fundo zerado de uma mamografia, por exemplo, não
+// puxa mais o percentil de 0,5% para o valor de padding.
+static void ExcludeFromHistogram(PixelHistogram& h, double lo, double hi)
+{
+    if (h.empty() || hi < lo) return;
+    const double n = static_cast<double>(h.bins.size());
+    const double a = std::max(0.0, std::ceil((lo - h.binLow) / h.binWidth));
+    const double b = std::min(n - 1.0, std::floor((hi - h.binLow) / h.binWidth));
+    if (b < a) return;
+    for (size_t i = static_cast<size_t>(a); i <= static_cast<size_t>(b); ++i) h.bins[i] = 0;
+    UpdateHistogramTotals(h);
+}
+
+// -------------------- janela por percentis --------------------
+// Ex.: 0,5% e 99,5% ignoram marcadores e fundo que estragam o min/max.
+// Devolve em valores de modalidade (aplica slope/intercept).
+static constexpr double kAutoWindowLowPct = 0.5;
+static constexpr double kAutoWindowHighPct = 99.5;
+
+static WindowRange PercentileWindow(const PixelHistogram& h, double lowPct, double highPct,
+                                    const SampleTransform& xf = SampleTransform())
+{
+    if (h.empty()) return { 0.0, 1.0 };
+    double lo = h.percentile(lowPct / 100.0);
+    double hi = h.percentile(highPct / 100.0);
+    if (!(hi > lo)) { lo = h.minValue; hi = h.maxValue; }
+    if (!(hi > lo)) hi = lo + 1.0;
+    const double a = xf.modality(lo);
+    const double b = xf.modality(hi);
+    return { std::min(a, b), std::max(a, b) };
+}
+
+#endif //READ_DICOM_GDCM_DICOM_STATS_H
@@ -0,0 +1,217 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_DICOM_TAG_SCHEMA_H
+#define READ_DICOM_GDCM_DICOM_TAG_SCHEMA_H
+#include <gdcmDataSet.h>
+#include <gdcmDataElement.h>
+#include <gdcmByteValue.h>
+#include <gdcmTag.h>
+#include <gdcmVR.h>
+
+#include <array>
+#include <string_view>
+#include <optional>
+#include <type_traits>
+#include <charconv>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+// -------------------- schema de tags em tempo de compilação --------------------
+// Declara-se uma struct de destino e, uma vez, a lista de tags com VR e membro:
+//
+//   struct Info { std::string_view name; DicomDate date; std::optional<uint16_t> rows; };
+//   using InfoSchema = TagSchema<
+//       TagField<0x0008,0x0020, gdcm::VR::DA, &Info::date>,
+//       TagField<0x0010,0x0010, gdcm::VR::PN, &Info::name>,
+//       TagField<0x0028,0x0010, gdcm::VR::US, &Info::rows>>;
+//
+//   Info info; InfoSchema::Extract(ds, info);
+//
+// Extract() percorre o DataSet uma única vez (os dois lados estão ordenados
+// por tag) e não aloca: textos viram string_view apontando para os bytes do
+// DataSet, que portanto precisa viver mais que a struct preenchida.
+
+// Data DA (AAAAMMDD) sem alocação
+struct DicomDate
+{
+    std::string_view raw;
+    int year = 0;
+    int month = 0;
+    int day = 0;
+
+    bool valid() const { return year > 0 && month >= 1 && month <= 12 && day >= 1 && day <= 31; }
+
+    // "AAAA/MM/DD" em buf (ou o texto original se não for uma data válida)
+    std::string_view format(char (&buf)[16], char sep = '/') const
+    {
+        if (!valid()) return raw;
+        const int n = std::snprintf(buf, sizeof(buf), "%04d%c%02d%c%02d", year, sep, month, sep, day);
+        return std::string_view(buf, static_cast<size_t>(n));
+    }
+};
+
+namespace tag_schema_detail {
+
+template<typename M> struct MemberTraits;
+template<typename C, typename T> struct MemberTraits<T C::*> { typedef C Owner; typedef T Value; };
+
+template<typename T> struct Unwrap { typedef T Type; };
+template<typename T> struct Unwrap<std::optional<T>> { typedef T Type; };
+
+static inline std::string_view TrimPadding(const char* p, size_t n)
+{
+    while (n > 0 && (p[n-1] == ' ' || p[n-1] == '\0')) --n;
+    return std::string_view(p, n);
+}
+
+// primeiro valor de um campo multivalorado de texto (DS/IS), sem espaços
+static inline std::string_view FirstValue(std::string_view s)
+{
+    const size_t sep = s.find('\\');
+    if (sep != std::string_view::npos) s = s.substr(0, sep);
+    while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+    while (!s.empty() && s.back() == ' ') s.remove_suffix(1);
+    return s;
+}
+
+template<typename T>
+static inline bool ParseNumber(std::string_view s, T& v)
+{
+    if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+    return r.ec == std::errc() && r.ptr != s.data();
+}
+
+template<typename T>
+static inline bool ReadBinary(const char* p, size_t n, T& v)
+{
+    if (n < sizeof(T)) return false;
+    std::memcpy(&v, p, sizeof(T));   // VRs binárias na ordem do arquivo (little endian)
+    return true;
+}
+
+static inline bool ParseDate(std::string_view s, DicomDate& d)
+{
+    d.raw = s;
+    if (s.size() < 8) return false;
+    return ParseNumber(s.substr(0, 4), d.year) && ParseNumber(s.substr(4, 2), d.month)
+        && ParseNumber(s.substr(6, 2), d.day);
+}
+
+static constexpr bool IsTextVR(gdcm::VR::VRType v)
+{
+    return v == gdcm::VR::AE || v == gdcm::VR::AS || v == gdcm::VR::CS || v == gdcm::VR::DA
+        || v == gdcm::VR::DS || v == gdcm::VR::DT || v == gdcm::VR::IS || v == gdcm::VR::LO
+        || v == gdcm::VR::LT || v == gdcm::VR::PN || v == gdcm::VR::SH || v == gdcm::VR::ST
+        || v == gdcm::VR::TM || v == gdcm::VR::UI || v == gdcm::VR::UT;
+}
+
+// Combinações VR -> tipo de destino aceitas
+template<gdcm::VR::VRType V, typename T>
+static constexpr bool Accepts()
+{
+    if constexpr (std::is_same<T, std::string_view>::value) return IsTextVR(V);
+    else if constexpr (std::is_same<T, DicomDate>::value)   return V == gdcm::VR::DA;
+    else if constexpr (std::is_floating_point<T>::value)
+        return V == gdcm::VR::DS || V == gdcm::VR::IS || V == gdcm::VR::FD || V == gdcm::VR::FL;
+    else if constexpr (std::is_integral<T>::value)
+        return V == gdcm::VR::IS || V == gdcm::VR::US || V == gdcm::VR::SS
+            || V == gdcm::VR::UL || V == gdcm::VR::SL;
+    else return false;
+}
+
+template<gdcm::VR::VRType V, typename T>
+static inline bool ParseValue(const char* p, size_t n, T& v)
+{
+    if constexpr (std::is_same<T, std::string_view>::value) {
+        v = TrimPadding(p, n);
+        return true;
+    } else if constexpr (std::is_same<T, DicomDate>::value) {
+        return ParseDate(TrimPadding(p, n), v);
+    } else if constexpr (V == gdcm::VR::DS || V == gdcm::VR::IS) {
+        return ParseNumber(FirstValue(std::string_view(p, n)), v);
+    } else if constexpr (V == gdcm::VR::FD || V == gdcm::VR::FL) {
+        typedef typename std::conditional<V == gdcm::VR::FD, double, float>::type Bin;
+        Bin b;
+        if (!ReadBinary(p, n, b)) return false;
+        v = static_cast<T>(b);
+        return true;
+    } else {
+        typedef typename std::conditional<V == gdcm::VR::US, uint16_t,
+                typename std::conditional<V == gdcm::VR::SS, int16_t,
+                typename std::conditional<V == gdcm::VR::UL, uint32_t, int32_t>::type>::type>::type Bin;
+        Bin b;
+        if (!ReadBinary(p, n, b)) return false;
+        v = static_cast<T>(b);
+        return true;
+    }
+}
+
+template<size_t N>
+static constexpr bool StrictlyAscending(const std::array<uint32_t, N>& k)
+{
+    for (size_t i = 1; i < N; ++i)
+        if (!(k[i-1] < k[i])) return false;
+    return true;
+}
+
+} // namespace tag_schema_detail
+
+// Um campo: tag (grupo, elemento), VR esperada e membro de destino.
+// O membro pode ser std::optional<T> para distinguir "ausente" de "zero".
+template<uint16_t G, uint16_t E, gdcm::VR::VRType V, auto Member>
+struct TagField
+{
+    typedef tag_schema_detail::MemberTraits<decltype(Member)> Traits;
+    typedef typename Traits::Owner Owner;
+    typedef typename Traits::Value Value;
+    typedef typename tag_schema_detail::Unwrap<Value>::Type Target;
+
+    static constexpr uint32_t key = (static_cast<uint32_t>(G) << 16) | E;
+
+    static_assert(tag_schema_detail::Accepts<V, Target>(),
+                  "tipo do membro incompatível com a VR declarada");
+
+    static void Assign(Owner& o, const gdcm::DataElement& de)
+    {
+        const gdcm::ByteValue* bv = de.GetByteValue();
+        if (!bv) return;
+
+        Target v{};
+        if (tag_schema_detail::ParseValue<V>(bv->GetPointer(), bv->GetLength(), v))
+            o.*Member = v;
+    }
+};
+
+template<typename First, typename... Rest>
+struct TagSchema
+{
+    typedef typename First::Owner Owner;
+    static constexpr size_t size = 1 + sizeof...(Rest);
+    static constexpr std::array<uint32_t, size> keys = {{ First::key, Rest::key... }};
+
+    static_assert((std::is_same<typename Rest::Owner, Owner>::value && ...),
+                  "todos os campos do schema devem ser da mesma struct");
+    static_assert(tag_schema_detail::StrictlyAscending(keys),
+                  "tags do schema devem estar em ordem crescente e sem repetição");
+
+    // Uma passada sobre o DataSet; para no último tag do schema.
+    static void Extract(const gdcm::DataSet& ds, Owner& out)
+    {
+        typedef void (*Setter)(Owner&, const gdcm::DataElement&);
+        static constexpr Setter setters[size] = { &First::Assign, &Rest::Assign... };
+
+        size_t k = 0;
+        for (auto it = ds.Begin(); it != ds.End() && k < size; ++it) {
+            const uint32_t key = it->GetTag().GetElementTag();
+            while (k < size && keys[k] < key) ++k;      // campo ausente
+            if (k < size && keys[k] == key) setters[k++](out, *it);
+        }
+    }
+};
+
+#endif //READ_DICOM_GDCM_DICOM_TAG_SCHEMA_H
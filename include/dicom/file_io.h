@@ -0,0 +1,68 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_FILE_IO_H
+#define READ_DICOM_GDCM_FILE_IO_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <filesystem>
+#include <cstdint>
+
+// -------------------- identidade do arquivo --------------------
+// Entradas de cache e de índice valem enquanto caminho, mtime e tamanho não mudarem.
+struct FileStamp
+{
+    int64_t  mtime = 0;
+    uint64_t size = 0;
+    bool     valid = false;
+
+    bool operator==(const FileStamp& o) const { return valid && o.valid && mtime == o.mtime && size == o.size; }
+};
+
+static FileStamp StatFile(const std::filesystem::path& path)
+{
+    namespace fs = std::filesystem;
+    FileStamp st;
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) return st;
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec) return st;
+    st.size = size;
+    st.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    st.valid = true;
+    return st;
+}
+
+// -------------------- campos binários --------------------
+// Índice (dicom_scan.h) e miniaturas (dicom_cache.h): valores na ordem de
+// bytes nativa; texto = u32 len + bytes.
+template<typename T> static void PutBinary(std::ostream& o, const T& v)
+{
+    o.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+static void PutBinaryString(std::ostream& o, const std::string& s)
+{
+    PutBinary(o, static_cast<uint32_t>(s.size()));
+    o.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+template<typename T> static bool GetBinary(std::istream& i, T& v)
+{
+    return static_cast<bool>(i.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+// len acima de maxLen é tratado como arquivo corrompido (não aloca)
+static bool GetBinaryString(std::istream& i, std::string& s, uint32_t maxLen = 1u << 20)
+{
+    uint32_t n = 0;
+    if (!GetBinary(i, n) || n > maxLen) return false;
+    s.resize(n);
+    return static_cast<bool>(i.read(&s[0], n));
+}
+
+#endif //READ_DICOM_GDCM_FILE_IO_H
@@ -0,0 +1,99 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_MEMORY_STREAM_H
+#define READ_DICOM_GDCM_MEMORY_STREAM_H
+
+#include <streambuf>
+#include <istream>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+#include <dicom/perf_trace.h>
+
+// -------------------- leitura de arquivo para memória --------------------
+// Separa a E/S de disco da decodificação: o arquivo inteiro é lido numa
+// thread e o GDCM decodifica do buffer em outra (gdcm::Reader::SetStream).
+
+// streambuf somente leitura sobre um buffer existente (sem cópia), com seek
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+    MemoryStreamBuf(const char* p, size_t n)
+    {
+        char* b = const_cast<char*>(p);
+        setg(b, b, b + n);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+        char* base = eback();
+        char* pos = dir == std::ios_base::beg ? base + off
+                  : dir == std::ios_base::cur ? gptr() + off
+                  : egptr() + off;
+        if (pos < base || pos > egptr()) return pos_type(off_type(-1));
+        setg(base, pos, egptr());
+        return pos_type(pos - base);
+    }
+
+    pos_type seekpos(pos_type sp, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(sp), std::ios_base::beg, which);
+    }
+};
+
+class MemoryIStream : public std::istream
+{
+public:
+    MemoryIStream(const char* p, size_t n) : std::istream(nullptr), m_buf(p, n) { rdbuf(&m_buf); }
+
+private:
+    MemoryStreamBuf m_buf;
+};
+
+static bool ReadFileToBuffer(const std::string& path, std::vector<char>& out)
+{
+    PERF_SCOPE("file_io");
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    const std::streamsize n = f.tellg();
+    if (n < 0) return false;
+    out.resize(static_cast<size_t>(n));
+    f.seekg(0);
+    PerfCount(PerfBytesRead, static_cast<uint64_t>(n));
+    return static_cast<bool>(f.read(out.data(), n));
+}
+
+// Mesma leitura em blocos: progress(lidos, total) é chamado a cada bloco e,
+// se devolver false, a leitura para (cancelamento) e a função retorna false.
+static bool ReadFileToBuffer(const std::string& path, std::vector<char>& out,
+                             const std::function<bool(size_t, size_t)>& progress,
+                             size_t chunk = size_t(4) << 20)
+{
+    PERF_SCOPE("file_io");
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    const std::streamsize n = f.tellg();
+    if (n < 0) return false;
+    out.resize(static_cast<size_t>(n));
+    f.seekg(0);
+
+    const size_t total = static_cast<size_t>(n);
+    for (size_t done = 0; done < total; ) {
+        if (progress && !progress(done, total)) return false;
+        const size_t k = std::min(chunk, total - done);
+        if (!f.read(out.data() + done, static_cast<std::streamsize>(k))) return false;
+        PerfCount(PerfBytesRead, k);
+        done += k;
+    }
+    return !progress || progress(total, total);
+}
+
+#endif //READ_DICOM_GDCM_MEMORY_STREAM_H
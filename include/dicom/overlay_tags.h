@@ -0,0 +1,61 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_OVERLAY_TAGS_H
+#define READ_DICOM_GDCM_OVERLAY_TAGS_H
+#include <gdcmDataSet.h>
+#include <gdcmVR.h>
+
+#include <dicom/dicom_tag_schema.h>
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+
+// -------------------- tags do overlay --------------------
+// Texto do canto inferior direito do viewer. Fica num header para o
+// dicom_bench medir exatamente o mesmo caminho (etapa "tags").
+struct OverlayTags
+{
+    std::string_view patientName;
+    std::string_view patientId;
+    std::string_view modality;
+    std::string_view seriesDesc;
+    DicomDate        studyDate;
+    std::optional<uint16_t> rows;
+    std::optional<uint16_t> cols;
+};
+
+typedef TagSchema<
+    TagField<0x0008, 0x0020, gdcm::VR::DA, &OverlayTags::studyDate>,
+    TagField<0x0008, 0x0060, gdcm::VR::CS, &OverlayTags::modality>,
+    TagField<0x0008, 0x103E, gdcm::VR::LO, &OverlayTags::seriesDesc>,
+    TagField<0x0010, 0x0010, gdcm::VR::PN, &OverlayTags::patientName>,
+    TagField<0x0010, 0x0020, gdcm::VR::LO, &OverlayTags::patientId>,
+    TagField<0x0028, 0x0010, gdcm::VR::US, &OverlayTags::rows>,
+    TagField<0x0028, 0x0011, gdcm::VR::US, &OverlayTags::cols>
+> OverlayTagSchema;
+
+static std::string BuildMetadataText(const gdcm::DataSet& ds)
+{
+    OverlayTags tags;
+    OverlayTagSchema::Extract(ds, tags);
+
+    char dateBuf[16];
+    std::string metadata;
+    metadata.reserve(256);
+    metadata.append("PatientName: ").append(tags.patientName).append("\n");
+    metadata.append("PatientID:   ").append(tags.patientId).append("\n");
+    metadata.append("Modality:    ").append(tags.modality).append("\n");
+    metadata.append("StudyDate:   ").append(tags.studyDate.format(dateBuf)).append("\n");
+    metadata.append("SeriesDesc:  ").append(tags.seriesDesc).append("\n");
+    if (tags.rows && tags.cols) {
+        metadata.append("Rows x Cols: ").append(std::to_string(*tags.rows))
+                .append(" x ").append(std::to_string(*tags.cols)).append("\n");
+    }
+    return metadata;
+}
+
+#endif //READ_DICOM_GDCM_OVERLAY_TAGS_H
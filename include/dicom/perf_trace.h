@@ -0,0 +1,227 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_PERF_TRACE_H
+#define READ_DICOM_GDCM_PERF_TRACE_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+// -------------------- instrumentação por etapa --------------------
+// Timers de escopo (PERF_SCOPE) e contadores (PerfCount) em volta das etapas
+// do caminho de uma imagem: E/S, ir.Read(), GetBuffer, histograma, remap,
+// paintEvent... Desligado (padrão), cada ponto custa uma leitura atômica
+// relaxada; compilado com -DDICOM_NO_PERF_TRACE, nem isso.
+// Pixels processados são contados por etapa (PERF_SCOPE_PIXELS), não num
+// contador global: a mesma imagem passa por decodificação e remap, e somar
+// as duas contaria os mesmos pixels duas vezes.
+// Ligado, guarda eventos para exportar no formato Chrome trace (JSON aberto
+// em chrome://tracing ou ui.perfetto.dev) e um resumo por etapa para o
+// overlay do viewer.
+enum PerfCounter
+{
+    PerfBytesRead,
+    PerfAllocations,
+    PerfCounterCount
+};
+
+class PerfTrace
+{
+public:
+    struct StageStats
+    {
+        std::string name;
+        uint64_t count = 0;
+        uint64_t pixels = 0;    // soma dos pixels processados pela etapa
+        double   totalMs = 0.0;
+        double   lastMs = 0.0;
+    };
+
+    static PerfTrace& Instance()
+    {
+        static PerfTrace t;
+        return t;
+    }
+
+    static bool Enabled() { return Instance().m_enabled.load(std::memory_order_relaxed); }
+
+    void setEnabled(bool on) { m_enabled.store(on, std::memory_order_relaxed); }
+
+    // microssegundos desde o início do processo
+    int64_t nowUs() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_epoch).count();
+    }
+
+    // name deve ser um literal: o ponteiro é guardado e é a chave da etapa
+    // (sem std::string por evento dentro do lock)
+    void record(const char* name, int64_t startUs, int64_t durUs, uint64_t pixels = 0)
+    {
+        const int tid = ThreadIndex();
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_events.size() < kMaxEvents)
+            m_events.push_back({ name, tid, startUs, durUs, pixels });
+        else
+            ++m_dropped;
+
+        StageStats& s = m_stages[name];
+        ++s.count;
+        s.pixels += pixels;
+        s.lastMs = static_cast<double>(durUs) / 1000.0;
+        s.totalMs += s.lastMs;
+    }
+
+    void count(PerfCounter c, uint64_t n) { m_counters[c].fetch_add(n, std::memory_order_relaxed); }
+    uint64_t counter(PerfCounter c) const { return m_counters[c].load(std::memory_order_relaxed); }
+
+    // Por nome, em ordem alfabética. O mesmo literal pode ter endereços
+    // diferentes em unidades de tradução diferentes: as entradas são somadas.
+    std::vector<StageStats> summary() const
+    {
+        std::map<std::string, StageStats> byName;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            for (const auto& kv : m_stages) {
+                StageStats& s = byName[kv.first];
+                s.count += kv.second.count;
+                s.pixels += kv.second.pixels;
+                s.totalMs += kv.second.totalMs;
+                s.lastMs = kv.second.lastMs;
+            }
+        }
+        std::vector<StageStats> out;
+        for (auto& kv : byName) {
+            kv.second.name = kv.first;
+            out.push_back(std::move(kv.second));
+        }
+        return out;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_events.clear();
+        m_stages.clear();
+        m_dropped = 0;
+        for (auto& c : m_counters) c.store(0, std::memory_order_relaxed);
+    }
+
+    // Chrome trace: eventos "X" (duração) por thread e os contadores no fim.
+    bool writeChromeTrace(const std::string& path) const
+    {
+        std::ofstream f(path, std::ios::trunc);
+        if (!f) return false;
+
+        std::lock_guard<std::mutex> lk(m_mutex);
+        char buf[256];
+        f << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const Event& e : m_events) {
+            std::snprintf(buf, sizeof(buf),
+                          "%s{\"name\":\"%s\",\"cat\":\"dicom\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                          "\"ts\":%lld,\"dur\":%lld,\"args\":{\"pixels\":%llu}}",
+                          first ? "" : ",\n", e.name, e.tid,
+                          static_cast<long long>(e.startUs), static_cast<long long>(e.durUs),
+                          static_cast<unsigned long long>(e.pixels));
+            f << buf;
+            first = false;
+        }
+        std::snprintf(buf, sizeof(buf),
+                      "%s{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":%lld,"
+                      "\"args\":{\"bytes_read\":%llu,\"allocations\":%llu}}",
+                      first ? "" : ",\n", static_cast<long long>(nowUs()),
+                      static_cast<unsigned long long>(counter(PerfBytesRead)),
+                      static_cast<unsigned long long>(counter(PerfAllocations)));
+        f << buf << "\n],\n";
+        std::snprintf(buf, sizeof(buf), "\"otherData\":{\"dropped_events\":%zu}}\n", m_dropped);
+        f << buf;
+        return static_cast<bool>(f);
+    }
+
+private:
+    static constexpr size_t kMaxEvents = size_t(1) << 20;
+
+    struct Event
+    {
+        const char* name;
+        int     tid;
+        int64_t startUs;
+        int64_t durUs;
+        uint64_t pixels;
+    };
+
+    PerfTrace() : m_epoch(std::chrono::steady_clock::now())
+    {
+        for (auto& c : m_counters) c.store(0, std::memory_order_relaxed);
+    }
+
+    // índice pequeno e estável por thread (o trace fica legível)
+    static int ThreadIndex()
+    {
+        static std::atomic<int> next{1};
+        thread_local int id = next.fetch_add(1);
+        return id;
+    }
+
+    std::atomic<bool> m_enabled{false};
+    const std::chrono::steady_clock::time_point m_epoch;
+
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::unordered_map<const char*, StageStats> m_stages;   // chave: ponteiro do literal
+    size_t m_dropped = 0;
+    std::atomic<uint64_t> m_counters[PerfCounterCount];
+};
+
+// Mede o escopo em que foi declarado (se o trace estava ligado na entrada).
+class PerfScope
+{
+public:
+    explicit PerfScope(const char* name, uint64_t pixels = 0)
+        : m_name(PerfTrace::Enabled() ? name : nullptr),
+          m_start(m_name ? PerfTrace::Instance().nowUs() : 0),
+          m_pixels(pixels) {}
+
+    ~PerfScope()
+    {
+        if (!m_name) return;
+        PerfTrace& t = PerfTrace::Instance();
+        t.record(m_name, m_start, t.nowUs() - m_start, m_pixels);
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    const char* m_name;
+    int64_t     m_start;
+    uint64_t    m_pixels;
+};
+
+#ifdef DICOM_NO_PERF_TRACE
+#define PERF_SCOPE(name) ((void)0)
+#define PERF_SCOPE_PIXELS(name, pixels) ((void)0)
+static inline void PerfCount(PerfCounter, uint64_t) {}
+#else
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(name) PerfScope PERF_CONCAT(perfScope_, __LINE__)(name)
+#define PERF_SCOPE_PIXELS(name, pixels) PerfScope PERF_CONCAT(perfScope_, __LINE__)(name, pixels)
+static inline void PerfCount(PerfCounter c, uint64_t n)
+{
+    if (PerfTrace::Enabled()) PerfTrace::Instance().count(c, n);
+}
+#endif
+
+#endif //READ_DICOM_GDCM_PERF_TRACE_H
@@ -0,0 +1,100 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_PIXEL_KERNELS_H
+#define READ_DICOM_GDCM_PIXEL_KERNELS_H
+
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+// -------------------- tipo da amostra --------------------
+// O formato (bits alocados + sinal) é resolvido uma vez por imagem/linha em
+// DispatchSample; os kernels abaixo são instanciados por tipo e não têm
+// desvio por pixel.
+//   8  bits: uint8_t  / int8_t
+//   16 bits: uint16_t / int16_t (inclui 12 bits armazenados em 16)
+//   32 bits: uint32_t / int32_t
+template<typename F>
+static bool DispatchSample(int bitsAllocated, bool isSigned, F&& f)
+{
+    switch (bitsAllocated) {
+    case 8:  isSigned ? f(int8_t())  : f(uint8_t());  return true;
+    case 16: isSigned ? f(int16_t()) : f(uint16_t()); return true;
+    case 32: isSigned ? f(int32_t()) : f(uint32_t()); return true;
+    default: return false;
+    }
+}
+
+// -------------------- bits armazenados --------------------
+// Bits Stored < Bits Allocated (ex.: 12 em 16): descarta os bits acima de
+// High Bit (overlays antigos) e estende o sinal a partir do bit mais alto.
+// Idempotente para dados que o decoder já entregou limpos.
+// Requer 1 <= bitsStored <= bits do tipo e bitsStored-1 <= highBit < bits do
+// tipo (DicomReadRawImage corrige cabeçalhos fora disso antes de chamar).
+template<typename T>
+static void StoredBitsKernel(T* px, size_t n, int bitsStored, int highBit)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    const int shift = highBit + 1 - bitsStored;
+    const U mask = static_cast<U>((uint64_t(1) << bitsStored) - 1);
+    const U sign = static_cast<U>(uint64_t(1) << (bitsStored - 1));
+
+    for (size_t i = 0; i < n; ++i) {
+        U v = static_cast<U>(static_cast<U>(px[i]) >> shift) & mask;
+        if constexpr (std::is_signed<T>::value)
+            v = static_cast<U>((v ^ sign) - sign);   // extensão de sinal
+        px[i] = static_cast<T>(v);
+    }
+}
+
+// -------------------- planar -> intercalado --------------------
+// Planar Configuration = 1 (RRR..GGG..BBB..) para RGBRGB...
+template<typename T, int C>
+static void PlanarToInterleavedKernel(const T* __restrict src, T* __restrict dst, size_t pixels)
+{
+    for (int c = 0; c < C; ++c) {
+        const T* plane = src + static_cast<size_t>(c) * pixels;
+        for (size_t i = 0; i < pixels; ++i)
+            dst[i * C + c] = plane[i];
+    }
+}
+
+// -------------------- valor de modalidade -> 8 bits --------------------
+// Mesma fórmula para a LUT (8/16 bits) e para o cálculo direto (32 bits),
+// para que as duas saídas sejam idênticas.
+static inline uint8_t WindowValue(double p, double low, double high)
+{
+    if (p <= low)  return 0;
+    if (p >= high) return 255;
+    const double t = (p - low) / (high - low);
+    const long v = std::lround(t * 255.0);
+    return static_cast<uint8_t>(std::max(0L, std::min(255L, v)));
+}
+
+// Sem LUT (32 bits): Modality LUT (slope/intercept), janela e inversão
+// (MONOCHROME1) calculadas por amostra; Invert é resolvido em compilação.
+template<typename T, bool Invert>
+static void WindowKernel(const T* __restrict src, uint8_t* __restrict dst, size_t n,
+                         double slope, double intercept, double low, double high)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t o = WindowValue(static_cast<double>(src[i]) * slope + intercept, low, high);
+        dst[i] = Invert ? static_cast<uint8_t>(255 - o) : o;
+    }
+}
+
+// -------------------- RGB -> cinza --------------------
+// Luma BT.601 em inteiros (pesos somam 256).
+static inline void RgbToLumaKernel(const uint8_t* __restrict rgb, uint8_t* __restrict dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i) {
+        const unsigned r = rgb[3*i], g = rgb[3*i+1], b = rgb[3*i+2];
+        dst[i] = static_cast<uint8_t>((77u * r + 150u * g + 29u * b + 128u) >> 8);
+    }
+}
+
+#endif //READ_DICOM_GDCM_PIXEL_KERNELS_H
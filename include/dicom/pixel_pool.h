@@ -0,0 +1,163 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_PIXEL_POOL_H
+#define READ_DICOM_GDCM_PIXEL_POOL_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+
+#include <dicom/perf_trace.h>
+
+// -------------------- pool de buffers de pixels --------------------
+// Frames decodificados e imagens de 8 bits são grandes (dezenas de MB) e têm
+// quase sempre o mesmo tamanho. Em vez de alocar/liberar a cada abertura
+// (mmap/munmap + page faults), os blocos voltam para o pool e são reusados.
+// Blocos alinhados em 64 bytes, capacidade arredondada para 4 KiB.
+
+class PixelBufferPool
+{
+public:
+    static constexpr size_t kAlignment = 64;
+    static constexpr size_t kGranularity = 4096;
+
+    struct Stats
+    {
+        size_t hits = 0;            // acquire() atendido com bloco reciclado
+        size_t misses = 0;          // acquire() que precisou alocar
+        size_t cachedBytes = 0;     // bytes parados no pool
+        size_t liveBytes = 0;       // bytes emprestados
+    };
+
+    explicit PixelBufferPool(size_t maxCachedBytes = size_t(512) << 20)
+        : m_state(std::make_shared<State>())
+    {
+        m_state->maxCached = maxCachedBytes;
+    }
+
+    // pool padrão do processo
+    static PixelBufferPool& Default()
+    {
+        static PixelBufferPool pool;
+        return pool;
+    }
+
+    // Bloco com pelo menos n bytes; devolvido ao pool quando o último
+    // shared_ptr é destruído (mesmo que o PixelBufferPool já não exista).
+    std::shared_ptr<char> acquire(size_t n, size_t* capacity = nullptr)
+    {
+        const size_t want = RoundUp(n ? n : 1);
+        char* p = nullptr;
+        size_t cap = 0;
+        {
+            std::lock_guard<std::mutex> lk(m_state->mutex);
+            // aceita no máximo 1/8 de sobra para não prender blocos grandes em pedidos pequenos
+            auto it = m_state->free.lower_bound(want);
+            if (it != m_state->free.end() && it->first <= want + want / 8) {
+                cap = it->first;
+                p = it->second;
+                m_state->free.erase(it);
+                m_state->stats.cachedBytes -= cap;
+                ++m_state->stats.hits;
+            } else {
+                ++m_state->stats.misses;
+            }
+        }
+        if (!p) {
+            cap = want;
+            p = static_cast<char*>(std::aligned_alloc(kAlignment, cap));
+            if (!p) return nullptr;
+            PerfCount(PerfAllocations, 1);
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_state->mutex);
+            m_state->stats.liveBytes += cap;
+        }
+        if (capacity) *capacity = cap;
+
+        std::shared_ptr<State> st = m_state;
+        return std::shared_ptr<char>(p, [st, cap](char* q){ st->release(q, cap); });
+    }
+
+    // libera tudo que está parado no pool
+    void trim()
+    {
+        std::lock_guard<std::mutex> lk(m_state->mutex);
+        for (auto& kv : m_state->free) std::free(kv.second);
+        m_state->free.clear();
+        m_state->stats.cachedBytes = 0;
+    }
+
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lk(m_state->mutex);
+        return m_state->stats;
+    }
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        std::multimap<size_t, char*> free;
+        size_t maxCached = 0;
+        Stats  stats;
+
+        void release(char* p, size_t cap)
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            stats.liveBytes -= cap;
+            if (stats.cachedBytes + cap > maxCached) {
+                std::free(p);
+                return;
+            }
+            free.emplace(cap, p);
+            stats.cachedBytes += cap;
+        }
+
+        ~State()
+        {
+            for (auto& kv : free) std::free(kv.second);
+        }
+    };
+
+    static size_t RoundUp(size_t n) { return (n + kGranularity - 1) / kGranularity * kGranularity; }
+
+    std::shared_ptr<State> m_state;
+};
+
+// Buffer de pixels vindo do pool. Cópias compartilham a mesma memória.
+class PixelBuffer
+{
+public:
+    PixelBuffer() = default;
+
+    static PixelBuffer Allocate(size_t n, PixelBufferPool& pool = PixelBufferPool::Default())
+    {
+        PixelBuffer b;
+        b.m_mem = pool.acquire(n, &b.m_capacity);
+        b.m_size = b.m_mem ? n : 0;
+        return b;
+    }
+
+    char* data() { return m_mem.get(); }
+    const char* data() const { return m_mem.get(); }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    // reduz o tamanho lógico (sem realocar)
+    void truncate(size_t n) { if (n < m_size) m_size = n; }
+    void reset() { m_mem.reset(); m_size = 0; m_capacity = 0; }
+
+private:
+    std::shared_ptr<char> m_mem;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+};
+
+#endif //READ_DICOM_GDCM_PIXEL_POOL_H
@@ -0,0 +1,128 @@
+//
+// Created by dev on 18/10/2026.
+//
+
+#ifndef READ_DICOM_GDCM_PNG_WRITER_H
+#define READ_DICOM_GDCM_PNG_WRITER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+
+// -------------------- PNG mínimo (escala de cinza 8 bits) --------------------
+// Sem dependência de zlib/Qt: o fluxo zlib usa blocos deflate "stored" (sem
+// compressão). O arquivo fica do tamanho dos pixels, mas a codificação custa
+// praticamente só o CRC/Adler e qualquer leitor de PNG abre.
+
+static uint32_t PngCrc32(const uint8_t* p, size_t n, uint32_t crc = 0)
+{
+    static const auto table = []{
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PngPut32(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void PngChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t n)
+{
+    PngPut32(out, static_cast<uint32_t>(n));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + n);
+    PngPut32(out, PngCrc32(out.data() + start, n + 4));
+}
+
+// Codifica w x h pixels (stride em bytes) como PNG grayscale 8 bits em memória.
+static std::vector<uint8_t> EncodePngGray8(const uint8_t* px, int w, int h, size_t stride)
+{
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    std::vector<uint8_t> ihdr;
+    PngPut32(ihdr, static_cast<uint32_t>(w));
+    PngPut32(ihdr, static_cast<uint32_t>(h));
+    ihdr.insert(ihdr.end(), { 8, 0, 0, 0, 0 }); // 8 bits, grayscale, deflate, filtro 0, sem interlace
+    PngChunk(png, "IHDR", ihdr.data(), ihdr.size());
+
+    // dados filtrados: um byte de filtro (0) + a linha
+    const size_t rowLen = static_cast<size_t>(w) + 1;
+    const size_t rawLen = rowLen * static_cast<size_t>(h);
+    const size_t maxBlock = 65535;
+    const size_t blocks = rawLen ? (rawLen + maxBlock - 1) / maxBlock : 1;
+
+    std::vector<uint8_t> z;
+    z.reserve(2 + rawLen + blocks * 5 + 4);
+    z.push_back(0x78);
+    z.push_back(0x01);
+
+    uint32_t a = 1, b = 0;
+    size_t produced = 0;
+    size_t blockLeft = 0;
+    // copia n bytes do fluxo descomprimido, abrindo blocos stored conforme preciso
+    auto append = [&](const uint8_t* p, size_t n) {
+        while (n > 0) {
+            if (blockLeft == 0) {
+                const size_t len = std::min(maxBlock, rawLen - produced);
+                z.push_back(produced + len == rawLen ? 1 : 0);
+                z.push_back(static_cast<uint8_t>(len));
+                z.push_back(static_cast<uint8_t>(len >> 8));
+                z.push_back(static_cast<uint8_t>(~len));
+                z.push_back(static_cast<uint8_t>(~len >> 8));
+                blockLeft = len;
+            }
+            const size_t k = std::min(n, blockLeft);
+            z.insert(z.end(), p, p + k);
+
+            // Adler-32 com módulo adiado (5552 bytes não estouram 32 bits)
+            for (size_t i = 0; i < k; ) {
+                const size_t end = std::min(k, i + 5552);
+                for (; i < end; ++i) { a += p[i]; b += a; }
+                a %= 65521;
+                b %= 65521;
+            }
+
+            p += k; n -= k;
+            blockLeft -= k;
+            produced += k;
+        }
+    };
+    const uint8_t filterNone = 0;
+    for (int y = 0; y < h; ++y) {
+        append(&filterNone, 1);
+        append(px + static_cast<size_t>(y) * stride, static_cast<size_t>(w));
+    }
+    if (rawLen == 0) z.insert(z.end(), { 1, 0, 0, 0xFF, 0xFF });
+    PngPut32(z, (b << 16) | a);
+
+    PngChunk(png, "IDAT", z.data(), z.size());
+    PngChunk(png, "IEND", nullptr, 0);
+    return png;
+}
+
+static bool WriteFileBytes(const std::string& path, const void* data, size_t n)
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    const bool ok = std::fwrite(data, 1, n, f) == n;
+    return std::fclose(f) == 0 && ok;
+}
+
+#endif //READ_DICOM_GDCM_PNG_WRITER_H
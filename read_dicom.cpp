@@ -8,6 +8,10 @@
 #include <QPainter>
 #include <QImage>
 #include <QDir>
+#include <QStandardPaths>
+#include <QMenuBar>
+#include <QMenu>
+#include <QTimer>
 
 #include <gdcmImageReader.h>
 #include <gdcmImage.h>
@@ -18,7 +22,14 @@
 #include <gdcmByteValue.h>
 #include <gdcmAttribute.h>
 #include <dicom/dicom_lib.h>
+#include <dicom/overlay_tags.h>
 #include <dicom/DicomViewWidget.h>
+#include <dicom/dicom_series.h>
+#include <dicom/dicom_scan.h>
+#include <dicom/dicom_cache.h>
+#include <dicom/async_loader.h>
+#include <dicom/perf_trace.h>
+#include <dicom/background_tasks.h>
 
 #include <vector>
 #include <string>
@@ -26,88 +37,141 @@
 #include <cstdint>
 #include <cmath>
 #include <array>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <cstdlib>
 
 
 // -------------------- main --------------------
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
+    QApplication::setApplicationName("read_dicom");
 
+    // READ_DICOM_TRACE=arquivo.json liga a instrumentação e grava o trace ao sair
+    const char* tracePath = std::getenv("READ_DICOM_TRACE");
+    if (tracePath && *tracePath) PerfTrace::Instance().setEnabled(true);
+
+    // Cache em memória (READ_DICOM_CACHE_MB, padrão 1 GB) e miniaturas em disco
+    const char* cacheMb = std::getenv("READ_DICOM_CACHE_MB");
+    FrameCache cache((cacheMb ? std::strtoull(cacheMb, nullptr, 10) : 1024ull) << 20);
+    const std::string thumbDir =
+        (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails").toStdString();
+    ThumbnailStore thumbs(thumbDir);
+    thumbs.prune(256ull << 20);
 
-    QString path = QFileDialog::getOpenFileName(
-        nullptr,
-        argv[1],
-        QDir::currentPath(),
-        "*.dcm;;*.dicom"
-    );
-    if (path.isEmpty()) return 0;
-
-    gdcm::ImageReader ir;
-    ir.SetFileName(path.toStdString().c_str());
-    if (!ir.Read()) {
-        QMessageBox::critical(nullptr, "Erro", "Falha ao ler o arquivo DICOM com GDCM.");
-        return 1;
-    }
-//============================================================================================================
-    const gdcm::File& file = ir.GetFile();
-    const gdcm::DataSet& ds = file.GetDataSet();
-
-    std::string metadata;
-    metadata.append("PatientName: ");
-    metadata.append(GetStringTag(ds, 0x0010, 0x0010));
-    metadata.append("\n");
-    metadata.append("PatientID:   ");
-    metadata.append(GetStringTag(ds, 0x0010, 0x0020));
-    metadata.append("\n");
-    metadata.append("Modality:    ");
-    metadata.append(GetStringTag(ds, 0x0008, 0x0060));
-    metadata.append("\n");
-    metadata.append("StudyDate:   ");
-    std::string date = GetStringTag(ds, 0x0008, 0x0020);
-    date.insert(4,"/");
-    date.insert(7,"/");
-    metadata.append(date);
-    metadata.append("\n");
-    metadata.append("SeriesDesc:  ");
-    metadata.append(GetStringTag(ds, 0x0008, 0x103E));
-    metadata.append("\n");
-
-    // Rows/Cols via Attribute (bom para tags numéricas)
-    if (ds.FindDataElement(gdcm::Tag(0x0028, 0x0010)) && ds.FindDataElement(gdcm::Tag(0x0028, 0x0011))) {
-        gdcm::Attribute<0x0028,0x0010> rows;
-        gdcm::Attribute<0x0028,0x0011> cols;
-        rows.SetFromDataSet(ds);
-        cols.SetFromDataSet(ds);
-        metadata.append("Rows x Cols: ");
-        metadata.append(std::to_string(rows.GetValue()));
-        metadata.append(" x ");
-        metadata.append(std::to_string(cols.GetValue()));
-        metadata.append("\n");
-    }
-
-//============================================================================================================
-    QImage img = DicomToQImage_Grayscale8(ir);
-    if (img.isNull()) {
-        QMessageBox::critical(nullptr, "Erro",
-                              "Não consegui converter para imagem.\n"
-                              "Este exemplo suporta principalmente DICOM grayscale (1 canal) 8/16-bit.");
-        return 2;
-    }
-
-    // Texto do overlay (você pode colocar tags aqui também)
-    QString overlay = QFileInfo(path).fileName();
-
-    QString qmetadata = QString::fromStdString(metadata);
     QMainWindow win;
     win.setWindowTitle("Visualizador de imagens DICOM");
 
     auto* viewer = new DicomViewWidget;
-    viewer->setImage(img);
-    viewer->setOverlayText(qmetadata);
-
     win.setCentralWidget(viewer);
+
+    // Arquivos abrem em segundo plano: o cabeçalho vira overlay assim que é lido,
+    // a miniatura (se houver) aparece logo depois e a imagem completa no fim.
+    // Callbacks vêm da thread do loader e são repassados à GUI; resultados de um
+    // arquivo que já foi substituído por outro (id antigo) são ignorados.
+    uint64_t currentId = 0;
+    auto post = [viewer](auto fn) { QMetaObject::invokeMethod(viewer, fn, Qt::QueuedConnection); };
+
+    AsyncImageLoader::Callbacks cb;
+    cb.header = [&, post](uint64_t id, const gdcm::DataSet& ds) {
+        const QString text = QString::fromStdString(BuildMetadataText(ds));
+        post([&, id, text]{ if (id == currentId) viewer->setOverlayText(text); });
+    };
+    cb.preview = [&, post](uint64_t id, const Thumbnail& t) {
+        post([&, id, t]{
+            if (id == currentId)
+                viewer->setPreview(Gray8FrameToQImage(t.frame), QSize(t.sourceWidth, t.sourceHeight));
+        });
+    };
+    cb.progress = [&, post](uint64_t id, const char* stage, double fraction) {
+        const QString text = QString("Carregando: %1 %2%")
+                                 .arg(QString::fromUtf8(stage)).arg(static_cast<int>(fraction * 100.0));
+        post([&, id, text]{ if (id == currentId) viewer->setLoadingText(text); });
+    };
+    cb.done = [&, post](uint64_t id, const RawPyramid& levels, const std::string& error) {
+        post([&, id, levels, error]{
+            if (id != currentId) return;
+            viewer->setLoadingText(QString());
+            if (levels.empty())
+                QMessageBox::warning(&win, "Erro", QString::fromStdString(error));
+            else
+                viewer->setRawPyramid(levels, false);   // pixels crus: mudar a janela não relê o arquivo
+        });
+    };
+    auto loader = std::make_unique<AsyncImageLoader>(std::move(cb), &cache, &thumbs);
+
+    // Pastas abrem como série. Os cabeçalhos são lidos numa thread à parte
+    // (séries grandes levam segundos) e o resultado volta pela fila da GUI;
+    // abrir outra pasta ou um arquivo antes disso descarta a leitura antiga.
+    const int seriesThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency())) - 1;
+    uint64_t currentSeriesId = 0;
+    BackgroundTasks tasks;   // depois de viewer/cache: destruído (e esperado) antes deles
+
+    auto openFile = [&](const QString& path) {
+        if (path.isEmpty()) return;
+        ++currentSeriesId;
+        viewer->setSeries(nullptr);
+        currentId = loader->load(path.toStdString());
+        viewer->setLoadingText("Carregando: " + QFileInfo(path).fileName());
+    };
+    auto openDialog = [&] {
+        openFile(QFileDialog::getOpenFileName(&win, "Abrir arquivo DICOM", QDir::currentPath(),
+                                              "*.dcm;;*.dicom"));
+    };
+
+    auto openSeries = [&](const QString& dir) {
+        if (dir.isEmpty()) return;
+        loader->cancel();
+        currentId = 0;   // ids do loader começam em 1
+        viewer->setSeries(nullptr);
+        viewer->setOverlayText(QString());
+        viewer->setLoadingText("Lendo pasta: " + QFileInfo(dir).fileName());
+
+        const uint64_t id = ++currentSeriesId;
+        tasks.run([&, post, id, path = dir.toStdString()]{
+            auto slices = std::make_shared<std::vector<SeriesSlice>>(ScanSeriesDirectory(path, seriesThreads));
+            QString overlay;
+            gdcm::Reader hr;
+            if (!slices->empty() && ReadDicomHeader(slices->front().path, hr))
+                overlay = QString::fromStdString(BuildMetadataText(hr.GetFile().GetDataSet()));
+
+            post([&, id, slices, overlay]{
+                if (id != currentSeriesId) return;
+                viewer->setLoadingText(QString());
+                if (slices->empty()) {
+                    QMessageBox::warning(&win, "Erro", "Nenhum arquivo DICOM encontrado na pasta.");
+                    return;
+                }
+                viewer->setOverlayText(overlay);
+                viewer->setSeries(std::make_unique<SeriesLoader>(std::move(*slices), seriesThreads, 8,
+                                                                  size_t(1) << 30, &cache, &thumbs));
+            });
+        });
+    };
+    auto openSeriesDialog = [&] {
+        openSeries(QFileDialog::getExistingDirectory(&win, "Abrir pasta com uma série DICOM", QDir::currentPath()));
+    };
+
+    QMenu* fileMenu = win.menuBar()->addMenu("&Arquivo");
+    fileMenu->addAction("&Abrir...", &win, openDialog, QKeySequence(QKeySequence::Open));
+    fileMenu->addAction("Abrir &pasta...", &win, openSeriesDialog, QKeySequence("Ctrl+Shift+O"));
+    fileMenu->addAction("&Sair", &win, [&]{ win.close(); }, QKeySequence(QKeySequence::Quit));
+
+    // Uma pasta na linha de comando abre a série inteira
+    if (argc > 1 && QFileInfo(QString::fromLocal8Bit(argv[1])).isDir())
+        openSeries(QString::fromLocal8Bit(argv[1]));
+    else if (argc > 1)
+        openFile(QString::fromLocal8Bit(argv[1]));
+    else
+        QTimer::singleShot(0, &win, openDialog);
+
     win.resize(1000, 800);
     win.show();
 
-    return app.exec();
-}
\ No newline at end of file
+    const int rc = app.exec();
+    if (tracePath && *tracePath) PerfTrace::Instance().writeChromeTrace(tracePath);
+    return rc;
+}